@@ -0,0 +1,43 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include "trace.h"
+using namespace std;
+
+// Results are collected here and written out in blocks of this size
+const size_t BATCH_BUFFER_SIZE = 1 << 20;
+
+// Read newline-delimited records from a file ("-" reads stdin) and call
+// classify(record, out) for each one; classify writes one result line to the
+// sink (plus any trace it was asked for). The record string and the output
+// buffer are reused for the whole run.
+template <typename Classify>
+int runBatch(const string& path, Classify classify) {
+    ios::sync_with_stdio(false);
+
+    ifstream file;
+    istream* in = &cin;
+    if(path != "-") {
+        file.open(path, ios::binary);
+        if(!file) {
+            cerr << "ERROR: Cannot open " << path << "\n";
+            return 1;
+        }
+        in = &file;
+    }
+
+    string record;
+    BufferedSink out(cout, BATCH_BUFFER_SIZE);
+    while(getline(*in, record)) {
+        if(!record.empty() && record.back() == '\r') {
+            record.pop_back();
+        }
+        classify(record, out);
+    }
+    return 0;
+}
+
+#endif // BATCH_H
@@ -0,0 +1,287 @@
+#ifndef DAWG_H
+#define DAWG_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "language.h"
+using namespace std;
+
+// Finite language stored as its minimal acyclic DFA (a DAWG). Words that
+// share a prefix share its path from the root, and words that share a suffix
+// share the nodes that read it, so (BA)^k with its |BA|^k words needs only
+// about k * |BA| nodes. Membership is one walk of the word.
+//
+// Nodes are hash-consed as they are made: a node is only added if no node
+// with the same accepting flag and edges exists. Building bottom-up (children
+// before parents) that keeps every result minimal. A DAWG is immutable; union
+// and concatenation build a new one.
+class DAWG {
+public:
+    static constexpr uint32_t NONE = 0xFFFFFFFF;
+
+private:
+    struct Edge {
+        unsigned char symbol;
+        uint32_t target;
+    };
+
+    struct Node {
+        uint32_t firstEdge;     // Edges are edges[firstEdge, firstEdge + edgeCount), sorted by symbol
+        uint32_t edgeCount;
+        bool accepting;
+        uint64_t words;         // Words accepted from this node, saturating
+    };
+
+    vector<Node> nodes;         // Children always come before their parents
+    vector<Edge> edges;
+    uint32_t root;              // NONE for the empty language
+    unordered_map<string, uint32_t> registry;   // Node signature -> node, while building
+
+    struct KeyHash {
+        size_t operator()(const vector<uint32_t>& key) const {
+            size_t hash = key.size();
+            for(uint32_t k : key) hash = hash * 0x9E3779B97F4A7C15ULL + k;
+            return hash;
+        }
+    };
+    using Memo = unordered_map<vector<uint32_t>, uint32_t, KeyHash>;
+
+    // The node with these edges, reusing an equal one if there is one
+    uint32_t intern(bool accepting, const vector<Edge>& out) {
+        if(!accepting && out.empty()) return NONE;
+        string signature(1 + 5 * out.size(), accepting ? '\1' : '\0');
+        for(size_t i = 0; i < out.size(); i++) {
+            signature[1 + 5 * i] = (char)out[i].symbol;
+            memcpy(&signature[2 + 5 * i], &out[i].target, 4);
+        }
+        auto found = registry.find(signature);
+        if(found != registry.end()) return found->second;
+
+        Node node{(uint32_t)edges.size(), (uint32_t)out.size(), accepting, accepting ? 1u : 0u};
+        for(const Edge& edge : out) {
+            edges.push_back(edge);
+            uint64_t below = nodes[edge.target].words;
+            node.words = (node.words + below < node.words) ? UINT64_MAX : node.words + below;
+        }
+        uint32_t id = (uint32_t)nodes.size();
+        nodes.push_back(node);
+        registry.emplace(move(signature), id);
+        return id;
+    }
+
+    // Copy another DAWG's nodes into this one; returns where its root went
+    uint32_t import(const DAWG& other) {
+        vector<uint32_t> mapped(other.nodes.size());
+        vector<Edge> out;
+        for(size_t i = 0; i < other.nodes.size(); i++) {
+            const Node& node = other.nodes[i];
+            out.clear();
+            for(uint32_t e = 0; e < node.edgeCount; e++) {
+                Edge edge = other.edges[node.firstEdge + e];
+                out.push_back(Edge{edge.symbol, mapped[edge.target]});
+            }
+            mapped[i] = intern(node.accepting, out);
+        }
+        return other.root == NONE ? NONE : mapped[other.root];
+    }
+
+    uint32_t child(uint32_t node, unsigned char symbol) const {
+        if(node == NONE) return NONE;
+        const Edge* first = edges.data() + nodes[node].firstEdge;
+        const Edge* last = first + nodes[node].edgeCount;
+        const Edge* found = lower_bound(first, last, symbol,
+            [](const Edge& edge, unsigned char c) { return edge.symbol < c; });
+        return (found != last && found->symbol == symbol) ? found->target : NONE;
+    }
+
+    // Node for left . L2 + (union of the nodes in right), where L2 is the
+    // language of rightRoot: a run is either still in the left operand (at
+    // `left`) or has moved on to L2 at one of several nodes at once. Entering
+    // an accepting left node starts another copy of L2. With left == NONE
+    // this is a plain union.
+    uint32_t combine(uint32_t left, vector<uint32_t> right, uint32_t rightRoot, Memo& memo) {
+        sort(right.begin(), right.end());
+        right.erase(unique(right.begin(), right.end()), right.end());
+        if(!right.empty() && right.back() == NONE) right.pop_back();
+        if(left == NONE && right.size() <= 1) return right.empty() ? NONE : right[0];
+
+        vector<uint32_t> key(1, left);
+        key.insert(key.end(), right.begin(), right.end());
+        auto found = memo.find(key);
+        if(found != memo.end()) return found->second;
+
+        bool accepting = false;
+        for(uint32_t node : right) accepting = accepting || nodes[node].accepting;
+        vector<unsigned char> symbols;
+        for(uint32_t node : key) {
+            if(node == NONE) continue;
+            for(uint32_t e = 0; e < nodes[node].edgeCount; e++) symbols.push_back(edges[nodes[node].firstEdge + e].symbol);
+        }
+        sort(symbols.begin(), symbols.end());
+        symbols.erase(unique(symbols.begin(), symbols.end()), symbols.end());
+
+        vector<Edge> out;
+        for(unsigned char symbol : symbols) {
+            uint32_t nextLeft = child(left, symbol);
+            vector<uint32_t> nextRight;
+            for(uint32_t node : right) nextRight.push_back(child(node, symbol));
+            if(nextLeft != NONE && nodes[nextLeft].accepting) nextRight.push_back(rightRoot);
+            uint32_t target = combine(nextLeft, move(nextRight), rightRoot, memo);
+            if(target != NONE) out.push_back(Edge{symbol, target});
+        }
+        uint32_t id = intern(accepting, out);
+        memo.emplace(move(key), id);
+        return id;
+    }
+
+    // Done building: drop the nodes the root cannot reach (parts of imported
+    // operands the result does not use), keeping children before parents.
+    // The registry is only needed while nodes are added.
+    void finish() {
+        unordered_map<string, uint32_t>().swap(registry);
+        vector<uint32_t> renumbered(nodes.size(), NONE);
+        if(root != NONE) {
+            vector<bool> reachable(root + 1, false);
+            reachable[root] = true;
+            for(uint32_t i = root + 1; i-- > 0; ) {
+                if(!reachable[i]) continue;
+                for(uint32_t e = 0; e < nodes[i].edgeCount; e++) reachable[edges[nodes[i].firstEdge + e].target] = true;
+            }
+            uint32_t next = 0;
+            for(uint32_t i = 0; i <= root; i++) {
+                if(reachable[i]) renumbered[i] = next++;
+            }
+        }
+
+        vector<Node> keptNodes;
+        vector<Edge> keptEdges;
+        for(uint32_t i = 0; i < nodes.size(); i++) {
+            if(renumbered[i] == NONE) continue;
+            Node node = nodes[i];
+            node.firstEdge = (uint32_t)keptEdges.size();
+            for(uint32_t e = 0; e < nodes[i].edgeCount; e++) {
+                Edge edge = edges[nodes[i].firstEdge + e];
+                keptEdges.push_back(Edge{edge.symbol, renumbered[edge.target]});
+            }
+            keptNodes.push_back(node);
+        }
+        if(root != NONE) root = renumbered[root];
+        nodes.swap(keptNodes);
+        edges.swap(keptEdges);
+    }
+
+public:
+    DAWG() : root(NONE) {}
+
+    // Minimal DAWG of a list of words, in any order and with any repeats.
+    // Words are added in sorted order, so only the path of the last word is
+    // still open; nodes that the next word branches away from are final and
+    // get interned, deepest first.
+    explicit DAWG(const Language& words) : root(NONE) {
+        Language sorted = words;
+        sorted.sortUnique();
+        if(sorted.empty()) return;
+
+        struct Open {
+            bool accepting;
+            vector<Edge> out;   // The last edge leads to the next open node
+        };
+        vector<Open> path(1, Open{false, {}});
+        auto closeTo = [&](size_t depth) {
+            while(path.size() > depth + 1) {
+                uint32_t id = intern(path.back().accepting, path.back().out);
+                path.pop_back();
+                path.back().out.back().target = id;
+            }
+        };
+
+        string_view previous;
+        for(string_view word : sorted) {
+            size_t common = 0;
+            while(common < previous.size() && common < word.size() && previous[common] == word[common]) common++;
+            closeTo(common);
+            for(size_t i = common; i < word.size(); i++) {
+                path.back().out.push_back(Edge{(unsigned char)word[i], NONE});
+                path.push_back(Open{false, {}});
+            }
+            path.back().accepting = true;
+            previous = word;
+        }
+        closeTo(0);
+        root = intern(path[0].accepting, path[0].out);
+        finish();
+    }
+
+    static DAWG computeUnion(const DAWG& A, const DAWG& B) {
+        DAWG result;
+        uint32_t a = result.import(A), b = result.import(B);
+        Memo memo;
+        result.root = result.combine(NONE, {a, b}, NONE, memo);
+        result.finish();
+        return result;
+    }
+
+    static DAWG computeConcatenation(const DAWG& A, const DAWG& B) {
+        DAWG result;
+        uint32_t a = result.import(A), b = result.import(B);
+        if(a != NONE && b != NONE) {
+            Memo memo;
+            vector<uint32_t> right;
+            if(result.nodes[a].accepting) right.push_back(b);
+            result.root = result.combine(a, right, b, memo);
+        }
+        result.finish();
+        return result;
+    }
+
+    bool empty() const { return root == NONE; }
+    uint64_t size() const { return root == NONE ? 0 : nodes[root].words; }  // Saturates at UINT64_MAX
+    size_t nodeCount() const { return nodes.size(); }
+    size_t edgeCount() const { return edges.size(); }
+    size_t memoryBytes() const { return nodes.size() * sizeof(Node) + edges.size() * sizeof(Edge); }
+
+    // One walk from the root, O(word length)
+    bool contains(string_view word) const {
+        uint32_t node = root;
+        for(size_t i = 0; i < word.size() && node != NONE; i++) node = child(node, (unsigned char)word[i]);
+        return node != NONE && nodes[node].accepting;
+    }
+
+    // Call f(string_view) for every word in sorted order. Memory is one
+    // stack frame per symbol of the longest word.
+    template <typename F>
+    void forEachWord(F f) const {
+        if(root == NONE) return;
+        string word;
+        vector<pair<uint32_t, uint32_t>> stack(1, {root, 0});  // (node, next edge)
+        if(nodes[root].accepting) f(string_view(word));
+        while(!stack.empty()) {
+            uint32_t node = stack.back().first;
+            uint32_t next = stack.back().second;
+            if(next == nodes[node].edgeCount) {
+                stack.pop_back();
+                if(!stack.empty()) word.pop_back();
+                continue;
+            }
+            stack.back().second++;
+            const Edge& edge = edges[nodes[node].firstEdge + next];
+            word += (char)edge.symbol;
+            stack.push_back({edge.target, 0});
+            if(nodes[edge.target].accepting) f(string_view(word));
+        }
+    }
+
+    Language toLanguage() const {
+        Language result;
+        forEachWord([&](string_view word) { result.push_back(word); });
+        return result;
+    }
+};
+
+#endif // DAWG_H
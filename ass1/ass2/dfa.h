@@ -0,0 +1,399 @@
+#ifndef DFA_H
+#define DFA_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "simd_dfa.h"
+using namespace std;
+
+// Smallest unsigned type that can number `states` states and still keep its
+// maximum value free as the "no transition" marker
+template <size_t States>
+using StateTypeFor = typename conditional<(States < 0xFF), uint8_t,
+                     typename conditional<(States < 0xFFFF), uint16_t, uint32_t>::type>::type;
+
+template <typename State>
+class TableDFA;
+
+// What the rest of the input can still change once a run is in a state
+enum Verdict : uint8_t {
+    VERDICT_OPEN,       // Depends on the rest of the input
+    VERDICT_REJECT,     // Dead: no accepting state is reachable
+    VERDICT_ACCEPT      // Accepting sink: every reachable state accepts and has all its transitions
+};
+
+// Verdict of every state, for next(state, column) giving -1 where there is
+// no transition. Works to a fixed point on two flags per state, kept in
+// `verdict` itself so it also runs at compile time: "live" (an accepting
+// state is reachable) and "unsure" (a rejecting or incomplete state is).
+template <typename Next, typename Accepting, typename Verdicts>
+constexpr void computeVerdicts(int states, int columns, Next next, Accepting accepting, Verdicts& verdict) {
+    const uint8_t LIVE = 1, UNSURE = 2;
+    for(int s = 0; s < states; s++) {
+        verdict[s] = accepting(s) ? LIVE : UNSURE;
+        for(int c = 0; c < columns; c++) {
+            if(next(s, c) == -1) verdict[s] |= UNSURE;
+        }
+    }
+    for(bool changed = true; changed; ) {
+        changed = false;
+        for(int s = 0; s < states; s++) {
+            uint8_t flags = verdict[s];
+            for(int c = 0; c < columns; c++) {
+                int to = next(s, c);
+                if(to != -1) flags |= verdict[to];
+            }
+            if(flags != verdict[s]) {
+                verdict[s] = flags;
+                changed = true;
+            }
+        }
+    }
+    for(int s = 0; s < states; s++) {
+        verdict[s] = !(verdict[s] & LIVE) ? VERDICT_REJECT : !(verdict[s] & UNSURE) ? VERDICT_ACCEPT : VERDICT_OPEN;
+    }
+}
+
+// Describes a DFA over a small alphabet. Transitions are filled in with
+// setTransition and then frozen into a TableDFA with build().
+class DFABuilder {
+private:
+    int numStates;
+    string symbols;                 // symbols[i] is the input for column i
+    vector<int> transitions;        // Row-major, -1 for no transition
+    vector<bool> accepting;
+    int startState;
+
+public:
+    DFABuilder(int states, const string& alphabet) :
+        numStates(states),
+        symbols(alphabet),
+        transitions(states * alphabet.size(), -1),
+        accepting(states, false),
+        startState(0) {}
+
+    void setTransition(int from, char symbol, int to) {
+        size_t column = symbols.find(symbol);
+        if(from < 0 || from >= numStates || to < -1 || to >= numStates || column == string::npos) {
+            throw invalid_argument("DFABuilder: transition out of range");
+        }
+        transitions[from * symbols.size() + column] = to;
+    }
+
+    void setAccepting(int state, bool value = true) { accepting[state] = value; }
+    void setStart(int state) { startState = state; }
+
+    int getNumStates() const { return numStates; }
+    const string& getSymbols() const { return symbols; }
+    int getTransition(int from, size_t column) const { return transitions[from * symbols.size() + column]; }
+    bool isAccepting(int state) const { return accepting[state]; }
+    int getStart() const { return startState; }
+
+    template <typename State>
+    TableDFA<State> build() const;
+};
+
+// Upper bound on the entries of a TableDFA stride table (see buildStrideTable)
+const size_t STRIDE_TABLE_LIMIT = 1 << 14;
+
+// Symbols per shuffle-kernel block in TableDFA::run; a failing block is replayed
+const size_t SHUFFLE_BLOCK_SIZE = 1 << 12;
+
+// Inputs shorter than this skip the shuffle kernel, whose setup costs more
+// than it saves on a few symbols
+const size_t SHUFFLE_MIN_LENGTH = 64;
+
+// TableDFA::decide reads this many symbols first, then doubles up to the maximum
+const size_t DECIDE_FIRST_CHUNK = 16;
+const size_t DECIDE_MAX_CHUNK = 1 << 12;
+
+// Result of running a DFA over a buffer
+template <typename State>
+struct DFARun {
+    State state;        // State reached (the last valid one if the run stopped early)
+    size_t consumed;    // Symbols read; less than the input length if the run stopped
+    bool accepted;      // Whole input consumed and ended in an accepting state
+};
+
+// DFA with one flat row-major transition table of the narrowest state type.
+// Input bytes go through a 256-entry symbol-class table first; bytes outside
+// the alphabet map to an extra column whose entries are all NONE, so a single
+// check per step covers both missing transitions and invalid symbols.
+template <typename State>
+class TableDFA {
+public:
+    static const State NONE = numeric_limits<State>::max();
+
+private:
+    int numStates;
+    int numClasses;             // Alphabet size, not counting the invalid column
+    unsigned shift;             // Row stride is 1 << shift columns
+    vector<State> table;
+    array<uint8_t, 256> classOf;
+    vector<uint8_t> accepting;
+    State startState;
+    string symbols;
+    int strideLength;           // Symbols consumed per strideTable lookup, 1 if there is none
+    vector<State> strideTable;
+    vector<uint8_t> shuffleColumns; // simd_dfa.h columns, empty above 15 states
+    vector<uint8_t> verdicts;   // Verdict of each state
+    bool hasDecidedStates;      // Some state has a verdict other than VERDICT_OPEN
+
+    // Byte-indexed columns for the shuffle kernel. Lane numStates is the dead
+    // state that stands for NONE; it and any unused lanes map to themselves.
+    void buildShuffleColumns() {
+        if(numStates + 1 > SHUFFLE_LANES) return;
+        shuffleColumns.assign(256 * SHUFFLE_LANES, (uint8_t)numStates);
+        for(int b = 0; b < 256; b++) {
+            for(int s = 0; s < numStates; s++) {
+                State next = table[((size_t)s << shift) + classOf[b]];
+                shuffleColumns[SHUFFLE_LANES * b + s] = (next == NONE) ? (uint8_t)numStates : (uint8_t)next;
+            }
+            for(int s = numStates + 1; s < SHUFFLE_LANES; s++) {
+                shuffleColumns[SHUFFLE_LANES * b + s] = (uint8_t)s;
+            }
+        }
+    }
+
+    // Compose the transition table with itself over blocks of k symbols. A block
+    // index packs the k symbol classes `shift` bits apart (first symbol lowest),
+    // and entry (state << (k * shift)) | block is the state after the whole
+    // block, or NONE if any step in it fails. k is the largest value up to 8
+    // that keeps the table within STRIDE_TABLE_LIMIT entries.
+    void buildStrideTable() {
+        int k = 1;
+        while(k < 8 && ((size_t)numStates << ((k + 1) * shift)) <= STRIDE_TABLE_LIMIT) k++;
+        if(k < 2) return;
+
+        unsigned blockBits = k * shift;
+        size_t blocks = (size_t)1 << blockBits;
+        size_t mask = ((size_t)1 << shift) - 1;
+        strideTable.assign((size_t)numStates << blockBits, NONE);
+        for(int s = 0; s < numStates; s++) {
+            for(size_t block = 0; block < blocks; block++) {
+                State state = (State)s;
+                for(int j = 0; j < k && state != NONE; j++) {
+                    state = table[((size_t)state << shift) + ((block >> (j * shift)) & mask)];
+                }
+                strideTable[((size_t)s << blockBits) | block] = state;
+            }
+        }
+        strideLength = k;
+    }
+
+    // Advance over whole K-symbol blocks; stops in front of a block that fails
+    template <int K>
+    size_t runBlocks(const char* input, size_t length, State& state) const {
+        const State* blocks = strideTable.data();
+        const uint8_t* classes = classOf.data();
+        const unsigned blockBits = K * shift;
+        size_t i = 0;
+        for(; i + K <= length; i += K) {
+            size_t block = 0;
+            for(int j = 0; j < K; j++) {
+                block |= (size_t)classes[(unsigned char)input[i + j]] << (j * shift);
+            }
+            State next = blocks[((size_t)state << blockBits) | block];
+            if(next == NONE) break;
+            state = next;
+        }
+        return i;
+    }
+
+public:
+    TableDFA() : numStates(0), numClasses(0), shift(0), startState(0), strideLength(1), hasDecidedStates(false) {
+        classOf.fill(0);
+    }
+
+    explicit TableDFA(const DFABuilder& builder) :
+        numStates(builder.getNumStates()),
+        numClasses(builder.getSymbols().size()),
+        shift(0),
+        accepting(builder.getNumStates()),
+        startState(builder.getStart()),
+        symbols(builder.getSymbols()),
+        strideLength(1),
+        verdicts(builder.getNumStates()),
+        hasDecidedStates(false) {
+        if(numStates >= NONE || numClasses > 255) {
+            throw invalid_argument("TableDFA: automaton does not fit the state type");
+        }
+        while((1 << shift) < numClasses + 1) shift++;
+
+        classOf.fill(numClasses);
+        for(int c = 0; c < numClasses; c++) {
+            classOf[(unsigned char)symbols[c]] = c;
+        }
+
+        table.assign((size_t)numStates << shift, NONE);
+        for(int s = 0; s < numStates; s++) {
+            for(int c = 0; c < numClasses; c++) {
+                int to = builder.getTransition(s, c);
+                table[((size_t)s << shift) + c] = (to == -1) ? NONE : (State)to;
+            }
+            accepting[s] = builder.isAccepting(s);
+        }
+        buildStrideTable();
+        buildShuffleColumns();
+
+        computeVerdicts(numStates, numClasses,
+            [&](int state, int column) { return builder.getTransition(state, column); },
+            [&](int state) { return builder.isAccepting(state); }, verdicts);
+        for(uint8_t verdict : verdicts) {
+            if(verdict != VERDICT_OPEN) hasDecidedStates = true;
+        }
+    }
+
+    int getNumStates() const { return numStates; }
+    int getNumClasses() const { return numClasses; }
+    const string& getSymbols() const { return symbols; }
+    State getStart() const { return startState; }
+    bool isAccepting(int state) const { return accepting[state]; }
+    int classOfSymbol(char c) const { return classOf[(unsigned char)c]; }
+    int getStrideLength() const { return strideLength; }
+    Verdict getVerdict(int state) const { return (Verdict)verdicts[state]; }
+
+    // The shuffle kernel applies when all states and a dead state fit in 16 lanes
+    bool hasShuffleKernel() const { return !shuffleColumns.empty(); }
+    uint8_t deadLane() const { return (uint8_t)numStates; }
+
+    // Advance SHUFFLE_LANES states at once over the same input; lanes holding
+    // deadLane() are runs that failed. Requires hasShuffleKernel().
+    void advanceLanes(uint8_t* lanes, const char* input, size_t length) const {
+        shuffleAdvance(shuffleColumns.data(), lanes, numStates + 1, input, length);
+    }
+
+    // Single step; NONE if there is no transition or c is not in the alphabet
+    State step(State state, char c) const {
+        return table[((size_t)state << shift) + classOf[(unsigned char)c]];
+    }
+
+    // Transition for display code: -1 when there is none
+    int transition(int state, char c) const {
+        State next = step((State)state, c);
+        return next == NONE ? -1 : next;
+    }
+
+    // Run from `from` over input[0..length) and stop at the first missing transition.
+    // Small automata go through the vector shuffle kernel a block at a time,
+    // and a block that fails is replayed with the table walk for the exact stop.
+    DFARun<State> run(const char* input, size_t length, State from) const {
+        if(length < SHUFFLE_MIN_LENGTH || !hasShuffleKernel() || !shuffleKernelFast()) {
+            return runTable(input, length, from);
+        }
+
+        uint8_t lanes[SHUFFLE_LANES];
+        memset(lanes, deadLane(), sizeof(lanes));
+        lanes[0] = (uint8_t)from;
+        for(size_t i = 0; i < length; i += SHUFFLE_BLOCK_SIZE) {
+            size_t block = min(SHUFFLE_BLOCK_SIZE, length - i);
+            State entry = lanes[0];
+            advanceLanes(lanes, input + i, block);
+            if(lanes[0] == deadLane()) {
+                DFARun<State> replay = runTable(input + i, block, entry);
+                replay.consumed += i;
+                replay.accepted = false;
+                return replay;
+            }
+        }
+        State state = lanes[0];
+        return DFARun<State>{state, length, accepting[state] != 0};
+    }
+
+    // Table walk: whole blocks go through the stride table; the tail, and a
+    // block that fails, are replayed one symbol at a time to find the exact stop.
+    DFARun<State> runTable(const char* input, size_t length, State from) const {
+        const State* rows = table.data();
+        const uint8_t* classes = classOf.data();
+        State state = from;
+        size_t i = 0;
+        switch(strideLength) {
+            case 2: i = runBlocks<2>(input, length, state); break;
+            case 3: i = runBlocks<3>(input, length, state); break;
+            case 4: i = runBlocks<4>(input, length, state); break;
+            case 5: i = runBlocks<5>(input, length, state); break;
+            case 6: i = runBlocks<6>(input, length, state); break;
+            case 7: i = runBlocks<7>(input, length, state); break;
+            case 8: i = runBlocks<8>(input, length, state); break;
+            default: break;
+        }
+        for(; i < length; i++) {
+            State next = rows[((size_t)state << shift) + classes[(unsigned char)input[i]]];
+            if(next == NONE) break;
+            state = next;
+        }
+        return DFARun<State>{state, i, i == length && accepting[state]};
+    }
+
+    DFARun<State> run(const string& input) const {
+        return run(input.data(), input.size(), startState);
+    }
+
+    // Like run, but stops once the verdict no longer depends on the rest of the
+    // input (a dead state or an accepting sink). The verdict is the same as
+    // run's for input over the alphabet; symbols after the stop are not read,
+    // so callers that report invalid symbols must check those themselves.
+    // The input goes through run in chunks that start small and double, so
+    // an early decision costs only a few symbols.
+    DFARun<State> decide(const char* input, size_t length, State from) const {
+        if(!hasDecidedStates) return run(input, length, from);
+
+        State state = from;
+        size_t i = 0;
+        for(size_t chunk = DECIDE_FIRST_CHUNK; i < length && verdicts[state] == VERDICT_OPEN;
+            chunk = min(2 * chunk, DECIDE_MAX_CHUNK)) {
+            size_t block = min(chunk, length - i);
+            DFARun<State> part = run(input + i, block, state);
+            state = part.state;
+            i += part.consumed;
+            if(part.consumed != block) return DFARun<State>{state, i, false};
+        }
+        bool accepted = (verdicts[state] == VERDICT_OPEN) ? accepting[state] != 0 : verdicts[state] == VERDICT_ACCEPT;
+        return DFARun<State>{state, i, accepted};
+    }
+
+    bool accepts(const string& input) const {
+        return decide(input.data(), input.size(), startState).accepted;
+    }
+
+    // Same run, calling onStep(position, from, to) for every transition taken.
+    // Kept apart from the plain run so the untraced loop carries no hook.
+    template <typename OnStep>
+    DFARun<State> run(const char* input, size_t length, State from, OnStep onStep) const {
+        State state = from;
+        size_t i = 0;
+        for(; i < length; i++) {
+            State next = step(state, input[i]);
+            if(next == NONE) break;
+            onStep(i, state, next);
+            state = next;
+        }
+        return DFARun<State>{state, i, i == length && accepting[state]};
+    }
+};
+
+template <typename State>
+const State TableDFA<State>::NONE;
+
+template <typename State>
+TableDFA<State> DFABuilder::build() const {
+    return TableDFA<State>(*this);
+}
+
+// Build with the narrowest state type for this automaton and pass it to f
+template <typename F>
+auto withNarrowestDFA(const DFABuilder& builder, F f) -> decltype(f(builder.build<uint8_t>())) {
+    if(builder.getNumStates() < 0xFF) return f(builder.build<uint8_t>());
+    if(builder.getNumStates() < 0xFFFF) return f(builder.build<uint16_t>());
+    return f(builder.build<uint32_t>());
+}
+
+#endif // DFA_H
@@ -0,0 +1,120 @@
+#ifndef LANGUAGE_H
+#define LANGUAGE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+using namespace std;
+
+// A finite set of words (a language) in one arena: every word is stored back
+// to back in a single byte buffer, and an offset table marks where each one
+// starts. Words are read as string_views into the buffer, so a language of a
+// million words is two allocations instead of a million, and concatenations
+// are written straight into the buffer without temporary strings.
+class Language {
+private:
+    string bytes;               // All words, back to back
+    vector<size_t> offsets;     // Word i is bytes[offsets[i], offsets[i + 1])
+
+public:
+    class const_iterator {
+    private:
+        const Language* language;
+        size_t index;
+
+    public:
+        using iterator_category = forward_iterator_tag;
+        using value_type = string_view;
+        using difference_type = ptrdiff_t;
+        using pointer = const string_view*;
+        using reference = string_view;
+
+        const_iterator(const Language* owner, size_t position) : language(owner), index(position) {}
+        string_view operator*() const { return (*language)[index]; }
+        const_iterator& operator++() { index++; return *this; }
+        const_iterator operator++(int) { const_iterator before = *this; index++; return before; }
+        bool operator!=(const const_iterator& other) const { return index != other.index; }
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+    };
+
+    Language() : offsets(1, 0) {}
+
+    Language(initializer_list<const char*> words) : offsets(1, 0) {
+        for(const char* word : words) push_back(word);
+    }
+
+    explicit Language(const vector<string>& words) : offsets(1, 0) {
+        size_t total = 0;
+        for(const string& word : words) total += word.size();
+        reserve(words.size(), total);
+        for(const string& word : words) push_back(word);
+    }
+
+    void reserve(size_t words, size_t totalBytes) {
+        offsets.reserve(words + 1);
+        bytes.reserve(totalBytes);
+    }
+
+    void clear() {
+        bytes.clear();
+        offsets.assign(1, 0);
+    }
+
+    size_t size() const { return offsets.size() - 1; }
+    bool empty() const { return size() == 0; }
+    size_t byteSize() const { return bytes.size(); }  // Total length of all words
+
+    string_view operator[](size_t i) const {
+        return string_view(bytes.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    void push_back(string_view word) {
+        bytes.append(word.data(), word.size());
+        offsets.push_back(bytes.size());
+    }
+
+    // Append the word a + b, written directly into the arena
+    void pushConcat(string_view a, string_view b) {
+        bytes.append(a.data(), a.size());
+        bytes.append(b.data(), b.size());
+        offsets.push_back(bytes.size());
+    }
+
+    // Append all of another language's words
+    void append(const Language& other) {
+        size_t base = bytes.size();
+        bytes += other.bytes;
+        for(size_t i = 1; i < other.offsets.size(); i++) offsets.push_back(base + other.offsets[i]);
+    }
+
+    // Sort the words and drop duplicates. Only views are sorted; the arena is
+    // then rebuilt once in the new order.
+    void sortUnique() {
+        vector<string_view> views(begin(), end());
+        sort(views.begin(), views.end());
+        views.erase(unique(views.begin(), views.end()), views.end());
+
+        Language sorted;
+        size_t total = 0;
+        for(string_view word : views) total += word.size();
+        sorted.reserve(views.size(), total);
+        for(string_view word : views) sorted.push_back(word);
+        swap(sorted);
+    }
+
+    void swap(Language& other) {
+        bytes.swap(other.bytes);
+        offsets.swap(other.offsets);
+    }
+
+    vector<string> toVector() const { return vector<string>(begin(), end()); }
+};
+
+#endif // LANGUAGE_H
@@ -0,0 +1,211 @@
+#ifndef LANGUAGE_NFA_H
+#define LANGUAGE_NFA_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "language.h"
+using namespace std;
+
+// Regular expressions over finite languages (A o B, A U B, (BA)*, ...) as an
+// e-NFA, so membership is decided by reading the word once instead of
+// enumerating the language. A finite set becomes a trie; concatenation,
+// union and star are the usual e-move constructions.
+//
+// contains() runs the subset construction lazily: every set of NFA states it
+// meets becomes a cached DFA state with a 256-entry row, filled in as symbols
+// are seen. After a warm-up each symbol is one table lookup, whatever the
+// word's length or how many iterations of a star it spans. The cache makes
+// contains() unsafe to call from several threads on one object.
+class LanguageNFA {
+private:
+    struct State {
+        vector<pair<unsigned char, uint32_t>> moves;   // Sorted by symbol
+        vector<uint32_t> epsilon;
+        bool accepting = false;
+    };
+
+    vector<State> states;
+    uint32_t start;
+
+    static constexpr uint32_t UNKNOWN = 0xFFFFFFFF;
+    static constexpr uint32_t DEAD = 0;                 // Cached state of the empty set
+
+    // Cache at most this many DFA states (1 KiB of row each); past that the
+    // cache starts over at the next call
+    static constexpr size_t CACHE_LIMIT = 1 << 12;
+
+    struct SubsetHash {
+        size_t operator()(const vector<uint32_t>& subset) const {
+            size_t hash = subset.size();
+            for(uint32_t s : subset) hash = hash * 0x9E3779B97F4A7C15ULL + s;
+            return hash;
+        }
+    };
+
+    mutable vector<vector<uint32_t>> subsets;       // DFA state -> sorted, e-closed NFA states
+    mutable vector<array<uint32_t, 256>> rows;      // DFA transitions, UNKNOWN until first used
+    mutable vector<bool> subsetAccepting;
+    mutable unordered_map<vector<uint32_t>, uint32_t, SubsetHash> subsetIds;
+    mutable uint32_t startSubset = UNKNOWN;
+
+    uint32_t addState() {
+        states.emplace_back();
+        return (uint32_t)states.size() - 1;
+    }
+
+    // Copy another NFA's states in; returns the offset its state numbers moved by
+    uint32_t append(const LanguageNFA& other) {
+        uint32_t offset = (uint32_t)states.size();
+        for(const State& state : other.states) {
+            State copy = state;
+            for(auto& move : copy.moves) move.second += offset;
+            for(uint32_t& target : copy.epsilon) target += offset;
+            states.push_back(copy);
+        }
+        return offset;
+    }
+
+    void closeOver(vector<uint32_t>& subset) const {
+        vector<bool> seen(states.size(), false);
+        for(uint32_t s : subset) seen[s] = true;
+        for(size_t i = 0; i < subset.size(); i++) {
+            for(uint32_t target : states[subset[i]].epsilon) {
+                if(!seen[target]) {
+                    seen[target] = true;
+                    subset.push_back(target);
+                }
+            }
+        }
+        sort(subset.begin(), subset.end());
+    }
+
+    void resetCache() const {
+        subsets.clear();
+        rows.clear();
+        subsetAccepting.clear();
+        subsetIds.clear();
+        startSubset = UNKNOWN;
+        intern(vector<uint32_t>());     // DEAD
+    }
+
+    uint32_t intern(vector<uint32_t> subset) const {
+        auto found = subsetIds.find(subset);
+        if(found != subsetIds.end()) return found->second;
+        uint32_t id = (uint32_t)subsets.size();
+        bool accepting = false;
+        for(uint32_t s : subset) accepting = accepting || states[s].accepting;
+        subsetAccepting.push_back(accepting);
+        array<uint32_t, 256> row;
+        row.fill(id == DEAD ? DEAD : UNKNOWN);
+        rows.push_back(row);
+        subsetIds.emplace(subset, id);
+        subsets.push_back(move(subset));
+        return id;
+    }
+
+    uint32_t computeStep(uint32_t from, unsigned char c) const {
+        vector<uint32_t> next;
+        for(uint32_t s : subsets[from]) {
+            const auto& moves = states[s].moves;
+            auto it = lower_bound(moves.begin(), moves.end(), make_pair(c, (uint32_t)0));
+            for(; it != moves.end() && it->first == c; ++it) next.push_back(it->second);
+        }
+        sort(next.begin(), next.end());
+        next.erase(unique(next.begin(), next.end()), next.end());
+        closeOver(next);
+        uint32_t to = intern(move(next));
+        rows[from][c] = to;
+        return to;
+    }
+
+public:
+    // The language {""}: one accepting start state
+    LanguageNFA() : start(0) {
+        addState();
+        states[0].accepting = true;
+    }
+
+    // Trie of a finite set of words
+    static LanguageNFA words(const Language& language) {
+        LanguageNFA nfa;
+        nfa.states[0].accepting = false;
+        for(string_view word : language) {
+            uint32_t state = nfa.start;
+            for(char symbol : word) {
+                unsigned char c = (unsigned char)symbol;
+                auto& moves = nfa.states[state].moves;
+                auto it = lower_bound(moves.begin(), moves.end(), make_pair(c, (uint32_t)0));
+                if(it != moves.end() && it->first == c) {
+                    state = it->second;
+                    continue;
+                }
+                uint32_t next = nfa.addState();
+                auto& fresh = nfa.states[state].moves;   // addState may have moved the states
+                fresh.insert(lower_bound(fresh.begin(), fresh.end(), make_pair(c, (uint32_t)0)), make_pair(c, next));
+                state = next;
+            }
+            nfa.states[state].accepting = true;
+        }
+        return nfa;
+    }
+
+    // X o Y: e-moves from X's accepting states to Y's start
+    static LanguageNFA concatenation(const LanguageNFA& X, const LanguageNFA& Y) {
+        LanguageNFA nfa = X;
+        nfa.resetCache();
+        uint32_t offset = nfa.append(Y);
+        for(uint32_t s = 0; s < offset; s++) {
+            if(!nfa.states[s].accepting) continue;
+            nfa.states[s].accepting = false;
+            nfa.states[s].epsilon.push_back(Y.start + offset);
+        }
+        return nfa;
+    }
+
+    // X U Y: a new start with e-moves to both starts
+    static LanguageNFA alternation(const LanguageNFA& X, const LanguageNFA& Y) {
+        LanguageNFA nfa;
+        nfa.states[0].accepting = false;
+        uint32_t x = nfa.append(X), y = nfa.append(Y);
+        nfa.states[0].epsilon = {X.start + x, Y.start + y};
+        return nfa;
+    }
+
+    // X*: a new accepting start with an e-move into X, and e-moves from X's
+    // accepting states back to it
+    static LanguageNFA star(const LanguageNFA& X) {
+        LanguageNFA nfa;
+        uint32_t offset = nfa.append(X);
+        nfa.states[0].epsilon.push_back(X.start + offset);
+        for(uint32_t s = offset; s < nfa.states.size(); s++) {
+            if(nfa.states[s].accepting) nfa.states[s].epsilon.push_back(0);
+        }
+        return nfa;
+    }
+
+    size_t stateCount() const { return states.size(); }
+
+    // O(|w|) once the DFA states the word passes through are cached
+    bool contains(string_view word) const {
+        if(subsets.empty() || subsets.size() > CACHE_LIMIT) resetCache();
+        if(startSubset == UNKNOWN) {
+            vector<uint32_t> initial(1, start);
+            closeOver(initial);
+            startSubset = intern(move(initial));
+        }
+        uint32_t state = startSubset;
+        for(size_t i = 0; i < word.size() && state != DEAD; i++) {
+            unsigned char c = (unsigned char)word[i];
+            uint32_t next = rows[state][c];
+            state = (next != UNKNOWN) ? next : computeStep(state, c);
+        }
+        return subsetAccepting[state];
+    }
+};
+
+#endif // LANGUAGE_NFA_H
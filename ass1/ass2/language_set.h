@@ -0,0 +1,256 @@
+#ifndef LANGUAGE_SET_H
+#define LANGUAGE_SET_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "language.h"
+#include "parallel_dfa.h"
+using namespace std;
+
+// Union, intersection and difference of finite languages, two ways:
+//  - hashUnion etc. keep the words in the order they first appear, using an
+//    open-addressing hash set over the result. One pass, no sorting.
+//  - sortedUnion etc. return the words in sorted order. The inputs are
+//    sorted on up to `threads` threads (0 = all CPUs) and merged in parallel
+//    ranges, which is the path for sets of tens of millions of words.
+// Both drop duplicates, including duplicates within one input.
+
+// Below this many words per thread a parallel sort or merge is not worth it
+const size_t LANGUAGE_PARALLEL_MIN = 1 << 16;
+
+inline uint64_t hashWord(string_view word) {
+    const char* p = word.data();
+    size_t n = word.size();
+    uint64_t hash = 0x9E3779B97F4A7C15ULL ^ n;
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8) {
+        uint64_t block;
+        memcpy(&block, p + i, 8);
+        hash = (hash ^ block) * 0xBF58476D1CE4E5B9ULL;
+        hash ^= hash >> 31;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, p + i, n - i);
+    hash = (hash ^ tail) * 0x94D049BB133111EBULL;
+    return hash ^ (hash >> 29);
+}
+
+// Open-addressing hash set of words of one Language, stored as indices. Each
+// slot caches the upper half of the word's hash, so a probe only compares
+// strings when those 32 bits match. Linear probing, at most half full.
+class WordSet {
+private:
+    struct Slot {
+        uint32_t tag;       // Upper 32 bits of the hash
+        uint32_t word;      // Index into the language plus one, 0 if empty
+    };
+
+    const Language* words;
+    vector<Slot> slots;
+    size_t mask;
+    size_t count;
+
+    void grow() {
+        vector<Slot> old;
+        old.swap(slots);
+        slots.assign(old.size() * 2, Slot{0, 0});
+        mask = slots.size() - 1;
+        for(const Slot& slot : old) {
+            if(slot.word == 0) continue;
+            uint64_t hash = hashWord((*words)[slot.word - 1]);
+            size_t i = hash & mask;
+            while(slots[i].word != 0) i = (i + 1) & mask;
+            slots[i] = slot;
+        }
+    }
+
+public:
+    explicit WordSet(const Language& language, size_t expected = 0) : words(&language), count(0) {
+        size_t capacity = 16;
+        while(capacity < 2 * expected) capacity *= 2;
+        slots.assign(capacity, Slot{0, 0});
+        mask = capacity - 1;
+    }
+
+    size_t size() const { return count; }
+
+    bool contains(string_view word, uint64_t hash) const {
+        uint32_t tag = (uint32_t)(hash >> 32);
+        for(size_t i = hash & mask; slots[i].word != 0; i = (i + 1) & mask) {
+            if(slots[i].tag == tag && (*words)[slots[i].word - 1] == word) return true;
+        }
+        return false;
+    }
+
+    bool contains(string_view word) const { return contains(word, hashWord(word)); }
+
+    // Add word `index` of the language; false if an equal word is already in
+    bool insert(size_t index, uint64_t hash) {
+        if(2 * (count + 1) > slots.size()) grow();
+        string_view word = (*words)[index];
+        uint32_t tag = (uint32_t)(hash >> 32);
+        size_t i = hash & mask;
+        for(; slots[i].word != 0; i = (i + 1) & mask) {
+            if(slots[i].tag == tag && (*words)[slots[i].word - 1] == word) return false;
+        }
+        slots[i] = Slot{tag, (uint32_t)(index + 1)};
+        count++;
+        return true;
+    }
+};
+
+// Append `word` to result unless it is already there
+inline void addUnique(Language& result, WordSet& seen, string_view word) {
+    uint64_t hash = hashWord(word);
+    if(seen.contains(word, hash)) return;
+    result.push_back(word);
+    seen.insert(result.size() - 1, hash);
+}
+
+inline Language hashUnion(const Language& A, const Language& B) {
+    Language result;
+    result.reserve(A.size() + B.size(), A.byteSize() + B.byteSize());
+    WordSet seen(result, A.size() + B.size());
+    for(string_view word : A) addUnique(result, seen, word);
+    for(string_view word : B) addUnique(result, seen, word);
+    return result;
+}
+
+// Words of A that are also in B, in A's order
+inline Language hashIntersection(const Language& A, const Language& B) {
+    WordSet inB(B, B.size());
+    for(size_t i = 0; i < B.size(); i++) inB.insert(i, hashWord(B[i]));
+    Language result;
+    WordSet seen(result, min(A.size(), B.size()));
+    for(string_view word : A) {
+        if(inB.contains(word)) addUnique(result, seen, word);
+    }
+    return result;
+}
+
+// Words of A that are not in B, in A's order
+inline Language hashDifference(const Language& A, const Language& B) {
+    WordSet inB(B, B.size());
+    for(size_t i = 0; i < B.size(); i++) inB.insert(i, hashWord(B[i]));
+    Language result;
+    WordSet seen(result, A.size());
+    for(string_view word : A) {
+        if(!inB.contains(word)) addUnique(result, seen, word);
+    }
+    return result;
+}
+
+// The words of a language as sorted, duplicate-free views. Each thread sorts
+// one range, then the sorted runs are merged pairwise, the pairs of each
+// round in parallel.
+inline vector<string_view> sortedWords(const Language& words, int threads) {
+    vector<string_view> views(words.begin(), words.end());
+    if(threads <= 0) threads = defaultThreadCount();
+    threads = (int)max<size_t>(1, min<size_t>(threads, views.size() / LANGUAGE_PARALLEL_MIN));
+
+    vector<size_t> bounds = splitRange(views.size(), threads);
+    vector<thread> workers;
+    for(int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() { sort(views.begin() + bounds[t], views.begin() + bounds[t + 1]); });
+    }
+    for(thread& worker : workers) worker.join();
+
+    vector<string_view> merged(views.size());
+    for(size_t width = 1; width < (size_t)threads; width *= 2) {
+        workers.clear();
+        for(size_t t = 0; t < (size_t)threads; t += 2 * width) {
+            size_t begin = bounds[t], middle = bounds[min(t + width, (size_t)threads)];
+            size_t end = bounds[min(t + 2 * width, (size_t)threads)];
+            workers.emplace_back([&, begin, middle, end]() {
+                merge(views.begin() + begin, views.begin() + middle, views.begin() + middle, views.begin() + end,
+                      merged.begin() + begin);
+            });
+        }
+        for(thread& worker : workers) worker.join();
+        views.swap(merged);
+    }
+    views.erase(unique(views.begin(), views.end()), views.end());
+    return views;
+}
+
+enum SetOperation { SET_UNION, SET_INTERSECTION, SET_DIFFERENCE };
+
+// Merge two sorted, duplicate-free ranges under op
+inline void mergeSorted(SetOperation op, const string_view* a, const string_view* aEnd,
+                        const string_view* b, const string_view* bEnd, Language& result) {
+    while(a != aEnd && b != bEnd) {
+        int order = a->compare(*b);
+        if(order < 0) {
+            if(op != SET_INTERSECTION) result.push_back(*a);
+            a++;
+        } else if(order > 0) {
+            if(op == SET_UNION) result.push_back(*b);
+            b++;
+        } else {
+            if(op != SET_DIFFERENCE) result.push_back(*a);
+            a++;
+            b++;
+        }
+    }
+    if(op != SET_INTERSECTION) {
+        for(; a != aEnd; a++) result.push_back(*a);
+    }
+    if(op == SET_UNION) {
+        for(; b != bEnd; b++) result.push_back(*b);
+    }
+}
+
+// A op B in sorted order. After sorting, A is cut into ranges at evenly
+// spaced words and B at the same words, so every range pair can be merged
+// on its own thread; the partial results are then joined in order.
+inline Language sortedSetOperation(SetOperation op, const Language& A, const Language& B, int threads) {
+    if(threads <= 0) threads = defaultThreadCount();
+    vector<string_view> a = sortedWords(A, threads), b = sortedWords(B, threads);
+    int parts = (int)max<size_t>(1, min<size_t>(threads, (a.size() + b.size()) / LANGUAGE_PARALLEL_MIN));
+    if(a.empty()) parts = 1;
+
+    vector<size_t> aBounds = splitRange(a.size(), parts), bBounds(parts + 1, 0);
+    bBounds[parts] = b.size();
+    for(int t = 1; t < parts; t++) {
+        bBounds[t] = lower_bound(b.begin(), b.end(), a[aBounds[t]]) - b.begin();
+    }
+
+    vector<Language> pieces(parts);
+    auto work = [&](int t) {
+        mergeSorted(op, a.data() + aBounds[t], a.data() + aBounds[t + 1],
+                    b.data() + bBounds[t], b.data() + bBounds[t + 1], pieces[t]);
+    };
+    vector<thread> workers;
+    for(int t = 1; t < parts; t++) workers.emplace_back(work, t);
+    work(0);
+    for(thread& worker : workers) worker.join();
+
+    Language result;
+    size_t words = 0, bytes = 0;
+    for(const Language& piece : pieces) {
+        words += piece.size();
+        bytes += piece.byteSize();
+    }
+    result.reserve(words, bytes);
+    for(const Language& piece : pieces) result.append(piece);
+    return result;
+}
+
+inline Language sortedUnion(const Language& A, const Language& B, int threads = 0) {
+    return sortedSetOperation(SET_UNION, A, B, threads);
+}
+
+inline Language sortedIntersection(const Language& A, const Language& B, int threads = 0) {
+    return sortedSetOperation(SET_INTERSECTION, A, B, threads);
+}
+
+inline Language sortedDifference(const Language& A, const Language& B, int threads = 0) {
+    return sortedSetOperation(SET_DIFFERENCE, A, B, threads);
+}
+
+#endif // LANGUAGE_SET_H
@@ -0,0 +1,201 @@
+#ifndef PALINDROME_H
+#define PALINDROME_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "dfa.h"
+#include "simd_dfa.h"
+using namespace std;
+
+// Palindromes of one fixed length k over an alphabet, two ways:
+//  - palindromeDFA builds the minimal partial DFA. It has about 2 * m^(k/2)
+//    states for m symbols, so it is only built up to PALINDROME_DFA_STATE_LIMIT.
+//  - PalindromeMatcher compares the string with itself reversed, 16 bytes at
+//    a time with SSSE3, for any k and for bulk checks.
+// Both accept exactly the strings of length k over the alphabet that read
+// the same backwards.
+
+// Largest automaton palindromeDFA will build
+const long long PALINDROME_DFA_STATE_LIMIT = 1 << 12;
+
+// Strings of length 0..n-1 over m symbols: 1 + m + ... + m^(n-1), capped past the limit
+inline long long palindromeWordCount(size_t n, size_t m) {
+    long long total = 0, power = 1;
+    for(size_t i = 0; i < n && total <= PALINDROME_DFA_STATE_LIMIT; i++) {
+        total += power;
+        power = min<long long>(power * (long long)m, PALINDROME_DFA_STATE_LIMIT + 1);
+    }
+    return total;
+}
+
+// States of palindromeDFA(k, alphabet), or -1 if that is over PALINDROME_DFA_STATE_LIMIT
+inline long long palindromeDFAStates(size_t k, size_t m) {
+    size_t half = k / 2;
+    long long states = palindromeWordCount(half + 1, m) + palindromeWordCount(k % 2 ? half + 1 : half, m);
+    return states <= PALINDROME_DFA_STATE_LIMIT ? states : -1;
+}
+
+// Minimal DFA for the palindromes of length k. Reading the first k/2 symbols
+// walks a tree of states "read u"; after the middle symbol (odd k) the state
+// becomes "expect reverse(u)", and every further symbol must be the next
+// expected one. A wrong symbol has no transition. descriptions, if given,
+// gets a short label per state for traces.
+inline DFABuilder palindromeDFA(size_t k, const string& alphabet, vector<string>* descriptions = nullptr) {
+    const int m = alphabet.size();
+    const size_t half = k / 2;
+    const bool odd = (k % 2) != 0;
+    long long total = palindromeDFAStates(k, m);
+    if(total < 0) throw invalid_argument("palindromeDFA: automaton too large for this length");
+
+    // Words of length len are numbered in base m; offset[len] is where they start
+    vector<long long> offset(half + 2, 0);
+    for(size_t len = 1; len <= half + 1; len++) {
+        offset[len] = offset[len - 1] + (len == 1 ? 1 : (offset[len - 1] - offset[len - 2]) * m);
+    }
+    const long long readStates = offset[half + 1];
+    auto readState = [&](size_t len, long long value) { return (int)(offset[len] + value); };
+    // "Expect" states; with even k the full-length ones are the "read" states
+    auto expectState = [&](size_t len, long long value) {
+        return (!odd && len == half) ? readState(len, value) : (int)(readStates + offset[len] + value);
+    };
+    auto word = [&](size_t len, long long value) {
+        string text(len, ' ');
+        for(size_t i = len; i-- > 0; value /= m) text[i] = alphabet[value % m];
+        return text;
+    };
+
+    DFABuilder builder(total, alphabet);
+    if(descriptions != nullptr) descriptions->assign(total, "");
+    for(size_t len = 0; len <= half; len++) {
+        for(long long value = 0; value < offset[len + 1] - offset[len]; value++) {
+            int from = readState(len, value);
+            if(len < half || odd) {
+                for(int c = 0; c < m; c++) {
+                    int to = (len < half) ? readState(len + 1, value * m + c) : expectState(len, value);
+                    builder.setTransition(from, alphabet[c], to);
+                }
+            }
+            if(descriptions != nullptr) {
+                string read = word(len, value);
+                (*descriptions)[from] = (len == 0) ? "(Initial State)" : "(Read '" + read + "')";
+            }
+        }
+    }
+    for(size_t len = 0; len <= half; len++) {
+        for(long long value = 0; value < offset[len + 1] - offset[len]; value++) {
+            int from = expectState(len, value);
+            if(len > 0) {
+                builder.setTransition(from, alphabet[value % m], expectState(len - 1, value / m));
+            }
+            if(descriptions != nullptr && from >= readStates) {
+                string expected = word(len, value);
+                reverse(expected.begin(), expected.end());
+                (*descriptions)[from] = (len == 0) ? "(Final - Palindrome)" : "(Expect '" + expected + "')";
+            }
+        }
+    }
+    int accept = expectState(0, 0);
+    builder.setAccepting(accept, true);
+    if(descriptions != nullptr && k == 0) (*descriptions)[accept] = "(Final - Palindrome)";
+    builder.setStart(0);
+    return builder;
+}
+
+// Reverse-compare check for one fixed length
+class PalindromeMatcher {
+private:
+    size_t length;
+    array<bool, 256> member;
+    bool vectorAlphabet;            // All symbols ASCII, so the nibble tables cover them
+    alignas(16) uint8_t lowNibbleRows[16];  // Bit h set if byte (h << 4 | index) is a symbol
+
+    static bool mirroredScalar(const char* s, size_t n) {
+        for(size_t i = 0, j = n; i < j--; i++) {
+            if(s[i] != s[j]) return false;
+        }
+        return true;
+    }
+
+    bool membersScalar(const char* s, size_t n) const {
+        for(size_t i = 0; i < n; i++) {
+            if(!member[(unsigned char)s[i]]) return false;
+        }
+        return true;
+    }
+
+#ifdef SIMD_DFA_X86
+    // Each front block of 16 bytes against the matching back block, reversed
+    // with a byte shuffle. The last block is moved back to stay inside the
+    // string; the pairs it compares twice are harmless. Needs n >= 16.
+    __attribute__((target("ssse3")))
+    static bool mirroredSSSE3(const char* s, size_t n) {
+        const __m128i reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+        for(size_t p = 0; p < n / 2; p += 16) {
+            size_t q = min(p, n - 16);
+            __m128i front = _mm_loadu_si128((const __m128i*)(s + q));
+            __m128i back = _mm_loadu_si128((const __m128i*)(s + n - q - 16));
+            back = _mm_shuffle_epi8(back, reverse);
+            if(_mm_movemask_epi8(_mm_cmpeq_epi8(front, back)) != 0xFFFF) return false;
+        }
+        return true;
+    }
+
+    // Alphabet check over the blocks that cover the first half (enough for a
+    // mirrored string): one shuffle finds the row of the low nibble, a second
+    // the bit of the high nibble, which is 0 for non-ASCII bytes. Needs n >= 16.
+    __attribute__((target("ssse3")))
+    bool membersSSSE3(const char* s, size_t n) const {
+        const __m128i rows = _mm_load_si128((const __m128i*)lowNibbleRows);
+        const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, (char)128, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i nibble = _mm_set1_epi8(0x0F);
+        for(size_t p = 0; p < (n + 1) / 2; p += 16) {
+            __m128i block = _mm_loadu_si128((const __m128i*)(s + min(p, n - 16)));
+            __m128i row = _mm_shuffle_epi8(rows, _mm_and_si128(block, nibble));
+            __m128i bit = _mm_shuffle_epi8(bits, _mm_and_si128(_mm_srli_epi16(block, 4), nibble));
+            __m128i missing = _mm_cmpeq_epi8(_mm_and_si128(row, bit), _mm_setzero_si128());
+            if(_mm_movemask_epi8(missing) != 0) return false;
+        }
+        return true;
+    }
+#endif
+
+public:
+    PalindromeMatcher(size_t k, const string& alphabet) : length(k), vectorAlphabet(true) {
+        member.fill(false);
+        memset(lowNibbleRows, 0, sizeof(lowNibbleRows));
+        for(char c : alphabet) {
+            unsigned char b = (unsigned char)c;
+            member[b] = true;
+            if(b >= 0x80) vectorAlphabet = false;
+            else lowNibbleRows[b & 0x0F] |= (uint8_t)(1 << (b >> 4));
+        }
+    }
+
+    // True if s reads the same backwards, ignoring the alphabet
+    static bool mirrored(const char* s, size_t n) {
+#ifdef SIMD_DFA_X86
+        if(n >= 16 && shuffleKernelSupported()) return mirroredSSSE3(s, n);
+#endif
+        return mirroredScalar(s, n);
+    }
+
+    // Same verdict as the DFA. Once the string is known to be mirrored only
+    // its first half needs the alphabet check.
+    bool matches(const char* s, size_t n) const {
+        if(n != length || !mirrored(s, n)) return false;
+#ifdef SIMD_DFA_X86
+        if(n >= 16 && vectorAlphabet && shuffleKernelSupported()) return membersSSSE3(s, n);
+#endif
+        return membersScalar(s, (n + 1) / 2);
+    }
+
+    bool matches(const string& s) const { return matches(s.data(), s.size()); }
+};
+
+#endif // PALINDROME_H
@@ -0,0 +1,247 @@
+#ifndef PARALLEL_DFA_H
+#define PARALLEL_DFA_H
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/types.h>
+#include "dfa.h"
+using namespace std;
+
+// Symbols between merges of start states that have converged
+const size_t MAPPING_BLOCK_SIZE = 1 << 16;
+
+// Bytes read per fread in the file runners
+const size_t PARALLEL_CHUNK_SIZE = 1 << 20;
+
+// Tracks where each of several start states has got to over the same input.
+// Automata with at most 15 states keep every start state in one byte vector
+// and advance all of them with one shuffle per symbol. Larger ones run each
+// distinct state separately and merge start states that reach the same state,
+// so automata that synchronize (a trap state, a reset symbol) quickly drop to
+// a single run.
+template <typename State>
+class StateMapping {
+private:
+    const TableDFA<State>* dfa;
+    vector<State> distinct;     // Current state of each live run
+    vector<int> slot;           // Start state i follows distinct[slot[i]], -1 once failed
+    bool useLanes;              // Start state i is in lanes[i] instead
+    uint8_t lanes[SHUFFLE_LANES];
+
+    void merge() {
+        vector<State> merged;
+        vector<int> remap(distinct.size(), -1);
+        for(size_t d = 0; d < distinct.size(); d++) {
+            if(distinct[d] == TableDFA<State>::NONE) continue;
+            auto it = find(merged.begin(), merged.end(), distinct[d]);
+            remap[d] = (int)(it - merged.begin());
+            if(it == merged.end()) merged.push_back(distinct[d]);
+        }
+        for(int& s : slot) {
+            if(s != -1) s = remap[s];
+        }
+        distinct.swap(merged);
+    }
+
+public:
+    StateMapping(const TableDFA<State>& automaton, const vector<State>& starts) :
+        dfa(&automaton), distinct(starts), slot(starts.size()),
+        useLanes(automaton.hasShuffleKernel() && starts.size() <= (size_t)SHUFFLE_LANES) {
+        memset(lanes, automaton.deadLane(), sizeof(lanes));
+        for(size_t i = 0; i < starts.size(); i++) {
+            slot[i] = (int)i;
+            if(useLanes) lanes[i] = (uint8_t)starts[i];
+        }
+        merge();
+    }
+
+    // Advance every live run over input[0..length)
+    void advance(const char* input, size_t length) {
+        if(useLanes) {
+            dfa->advanceLanes(lanes, input, length);
+            return;
+        }
+        for(size_t pos = 0; pos < length && !distinct.empty(); pos += MAPPING_BLOCK_SIZE) {
+            size_t block = min(MAPPING_BLOCK_SIZE, length - pos);
+            for(State& state : distinct) {
+                auto run = dfa->run(input + pos, block, state);
+                state = (run.consumed == block) ? run.state : TableDFA<State>::NONE;
+            }
+            merge();
+        }
+    }
+
+    // State reached from the i-th start state, NONE if that run failed
+    State result(size_t i) const {
+        if(useLanes) {
+            return lanes[i] == dfa->deadLane() ? TableDFA<State>::NONE : (State)lanes[i];
+        }
+        return slot[i] == -1 ? TableDFA<State>::NONE : distinct[slot[i]];
+    }
+};
+
+// Every state of the automaton, in order, as start states for a mapping
+template <typename State>
+vector<State> allStates(const TableDFA<State>& dfa) {
+    vector<State> states(dfa.getNumStates());
+    for(int s = 0; s < dfa.getNumStates(); s++) states[s] = (State)s;
+    return states;
+}
+
+// Split [0, length) into `parts` contiguous ranges; returns part boundaries
+inline vector<size_t> splitRange(size_t length, int parts) {
+    vector<size_t> bounds(parts + 1);
+    for(int i = 0; i <= parts; i++) bounds[i] = length / parts * i;
+    bounds[parts] = length;
+    return bounds;
+}
+
+inline int defaultThreadCount() {
+    unsigned n = thread::hardware_concurrency();
+    return n > 0 ? (int)n : 1;
+}
+
+// Compose per-chunk mappings in order. chunkEnd(t, state) gives the state after
+// chunk t entered in `state`; the first failing chunk is replayed by `replay`
+// to find the exact stop offset.
+template <typename State, typename ChunkEnd, typename Replay>
+DFARun<State> composeChunks(const TableDFA<State>& dfa, const vector<size_t>& bounds,
+                            ChunkEnd chunkEnd, Replay replay) {
+    State state = dfa.getStart();
+    for(size_t t = 0; t + 1 < bounds.size(); t++) {
+        State next = chunkEnd(t, state);
+        if(next == TableDFA<State>::NONE) {
+            return replay(t, state);
+        }
+        state = next;
+    }
+    return DFARun<State>{state, bounds.back(), dfa.isAccepting(state)};
+}
+
+// Run the DFA over an in-memory input with up to `threads` threads. The first
+// chunk is run from the start state; every other chunk computes where each
+// possible entry state ends up. Composing the mappings in order gives exactly
+// the result of the serial run.
+template <typename State>
+DFARun<State> runParallel(const TableDFA<State>& dfa, const char* input, size_t length, int threads) {
+    if(threads <= 0) threads = defaultThreadCount();
+    threads = (int)max<size_t>(1, min<size_t>(threads, length / MAPPING_BLOCK_SIZE));
+    if(threads == 1) return dfa.run(input, length, dfa.getStart());
+
+    vector<size_t> bounds = splitRange(length, threads);
+    vector<StateMapping<State>> mappings;
+    for(int t = 0; t < threads; t++) {
+        mappings.emplace_back(dfa, t == 0 ? vector<State>{dfa.getStart()} : allStates(dfa));
+    }
+
+    vector<thread> workers;
+    for(int t = 1; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            mappings[t].advance(input + bounds[t], bounds[t + 1] - bounds[t]);
+        });
+    }
+    mappings[0].advance(input, bounds[1]);
+    for(thread& worker : workers) worker.join();
+
+    return composeChunks(dfa, bounds,
+        [&](size_t t, State entry) { return mappings[t].result(t == 0 ? 0 : entry); },
+        [&](size_t t, State entry) {
+            auto run = dfa.run(input + bounds[t], bounds[t + 1] - bounds[t], entry);
+            run.consumed += bounds[t];
+            run.accepted = false;
+            return run;
+        });
+}
+
+#ifdef _WIN32
+#define dfaSeek _fseeki64
+#define dfaTell _ftelli64
+#else
+#define dfaSeek(fp, off, whence) fseeko(fp, (off_t)(off), whence)
+#define dfaTell ftello
+#endif
+
+// Size of a file with one trailing line break ("\n" or "\r\n") left out; -1 on error
+inline long long inputFileSize(const string& path) {
+    FILE* fp = fopen(path.c_str(), "rb");
+    if(fp == nullptr) return -1;
+    long long size = -1;
+    if(dfaSeek(fp, 0, SEEK_END) == 0) size = (long long)dfaTell(fp);
+    char tail;
+    if(size >= 1 && dfaSeek(fp, size - 1, SEEK_SET) == 0 && fread(&tail, 1, 1, fp) == 1 && tail == '\n') {
+        size--;
+        if(size >= 1 && dfaSeek(fp, size - 1, SEEK_SET) == 0 && fread(&tail, 1, 1, fp) == 1 && tail == '\r') {
+            size--;
+        }
+    }
+    fclose(fp);
+    return size;
+}
+
+// Stream bytes [start, end) of a file through f(buffer, length) in fixed-size chunks
+template <typename F>
+bool forEachFileChunk(const string& path, long long start, long long end, F f) {
+    FILE* fp = fopen(path.c_str(), "rb");
+    if(fp == nullptr) return false;
+    vector<char> buffer(PARALLEL_CHUNK_SIZE);
+    bool ok = dfaSeek(fp, start, SEEK_SET) == 0;
+    for(long long pos = start; ok && pos < end; ) {
+        size_t want = (size_t)min<long long>(PARALLEL_CHUNK_SIZE, end - pos);
+        ok = fread(buffer.data(), 1, want, fp) == want && f(buffer.data(), want);
+        pos += want;
+    }
+    fclose(fp);
+    return ok;
+}
+
+// Run the DFA over a whole file (one trailing line break ignored) with up to
+// `threads` threads, each streaming its own byte range with constant memory.
+// Returns false on an I/O error.
+template <typename State>
+bool runFileParallel(const TableDFA<State>& dfa, const string& path, int threads, DFARun<State>& result) {
+    long long size = inputFileSize(path);
+    if(size < 0) return false;
+    if(threads <= 0) threads = defaultThreadCount();
+    threads = (int)max<long long>(1, min<long long>(threads, size / (long long)PARALLEL_CHUNK_SIZE));
+
+    vector<size_t> bounds = splitRange((size_t)size, threads);
+    vector<StateMapping<State>> mappings;
+    for(int t = 0; t < threads; t++) {
+        mappings.emplace_back(dfa, t == 0 ? vector<State>{dfa.getStart()} : allStates(dfa));
+    }
+
+    vector<char> ok(threads, 0);
+    auto work = [&](int t) {
+        ok[t] = forEachFileChunk(path, bounds[t], bounds[t + 1], [&](const char* buffer, size_t length) {
+            mappings[t].advance(buffer, length);
+            return true;
+        });
+    };
+    vector<thread> workers;
+    for(int t = 1; t < threads; t++) workers.emplace_back(work, t);
+    work(0);
+    for(thread& worker : workers) worker.join();
+    if(count(ok.begin(), ok.end(), 0) > 0) return false;
+
+    bool replayed = true;
+    result = composeChunks(dfa, bounds,
+        [&](size_t t, State entry) { return mappings[t].result(t == 0 ? 0 : entry); },
+        [&](size_t t, State entry) {
+            // Find the exact stop inside the failing range
+            DFARun<State> run{entry, bounds[t], false};
+            replayed = forEachFileChunk(path, bounds[t], bounds[t + 1], [&](const char* buffer, size_t length) {
+                auto part = dfa.run(buffer, length, run.state);
+                run.state = part.state;
+                run.consumed += part.consumed;
+                return part.consumed == length;
+            }) || run.consumed < bounds[t + 1];
+            return run;
+        });
+    return replayed;
+}
+
+#endif // PARALLEL_DFA_H
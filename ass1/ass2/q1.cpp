@@ -2,33 +2,38 @@
 #include <vector>
 #include <string>
 #include <iomanip>
+#include <cstdlib>
+#include "batch.h"
+#include "dfa.h"
+#include "static_dfa.h"
+#include "trace.h"
+#include "parallel_dfa.h"
 using namespace std;
 
+// Even number of 0s OR even number of 1s, fixed at compile time
+struct ParityDFA {
+    static constexpr int states = 4;
+    static constexpr char symbols[] = "01";
+    static constexpr int start = 0;
+    static constexpr bool partial = false;
+    static constexpr int table[states][2] = {
+        // Input 0   Input 1
+        {2, 1},     // q0 -> q2, q1
+        {3, 0},     // q1 -> q3, q0
+        {0, 3},     // q2 -> q0, q3
+        {1, 2},     // q3 -> q1, q2
+    };
+    static constexpr bool accepting[states] = {true, true, true, false};  // F = {q0, q1, q2}
+};
+
 class FiniteAutomata {
 private:
-    vector<vector<int>> transitionTable;
+    using Matcher = StaticDFA<ParityDFA>;
+    TableDFA<Matcher::State> dfa;       // Runtime copy used for tracing and display
     int currentState;
-    vector<bool> finalStates;
 
 public:
-    FiniteAutomata() {
-        transitionTable = vector<vector<int>>(4, vector<int>(2));
-        
-        // Transitions for input 0
-        transitionTable[0][0] = 2;  // q0 -> q2
-        transitionTable[1][0] = 3;  // q1 -> q3
-        transitionTable[2][0] = 0;  // q2 -> q0
-        transitionTable[3][0] = 1;  // q3 -> q1
-
-        // Transitions for input 1
-        transitionTable[0][1] = 1;  // q0 -> q1
-        transitionTable[1][1] = 0;  // q1 -> q0
-        transitionTable[2][1] = 3;  // q2 -> q3
-        transitionTable[3][1] = 2;  // q3 -> q2
-
-        finalStates = {true, true, true, false};
-        currentState = 0;
-    }
+    FiniteAutomata() : dfa(Matcher::builder()), currentState(0) {}
 
     bool isValidInput(const string& input) {
         for(char c : input) {
@@ -49,25 +54,68 @@ public:
         }
     }
 
-    bool processString(const string& input) {
-        currentState = 0;
-        cout << "\nTransitions:\n";
-        cout << "Initial State: q" << currentState << " " << getStateDescription(currentState) << "\n";
-        cout << string(50, '-') << "\n";
-        cout << setw(15) << "Input Symbol" << setw(15) << "Current State" 
-             << setw(15) << "Next State" << "\n";
-        cout << string(50, '-') << "\n";
+    // Run the automaton and write the requested trace to the sink. With
+    // TRACE_NONE this is the same loop as accepts(): no I/O, no allocation.
+    bool processString(const string& input, BufferedSink& trace, TraceLevel level = TRACE_STEPS) {
+        if(level == TRACE_NONE) {
+            return accepts(input);
+        }
 
-        for(char c : input) {
-            int nextState = transitionTable[currentState][c - '0'];
-            cout << setw(15) << c << setw(15) << "q" + to_string(currentState) 
-                 << setw(15) << "q" + to_string(nextState) << "\n";
-            currentState = nextState;
+        currentState = 0;
+        trace << "\nTransitions:\n";
+        trace << "Initial State: q" << currentState << " " << getStateDescription(currentState) << "\n";
+        if(level == TRACE_STEPS) {
+            trace.repeat('-', 50);
+            trace << "\n";
+            trace.column("Input Symbol", 15);
+            trace.column("Current State", 15);
+            trace.column("Next State", 15);
+            trace << "\n";
+            trace.repeat('-', 50);
+            trace << "\n";
         }
+
+        auto result = dfa.run(input.data(), input.size(), dfa.getStart(), [&](size_t i, int from, int to) {
+            if(level == TRACE_STEPS) {
+                trace.column(input[i], 15);
+                trace.stateColumn(from, 15);
+                trace.stateColumn(to, 15);
+                trace << "\n";
+            }
+        });
+        currentState = result.state;
         
-        cout << string(50, '-') << "\n";
-        cout << "Final State: q" << currentState << " " << getStateDescription(currentState) << "\n\n";
-        return finalStates[currentState];
+        if(level == TRACE_STEPS) {
+            trace.repeat('-', 50);
+            trace << "\n";
+        }
+        trace << "Final State: q" << currentState << " " << getStateDescription(currentState) << "\n\n";
+        return result.accepted;
+    }
+
+    // Run the automaton without printing anything
+    bool accepts(const string& input) {
+        auto result = Matcher::decide(input.data(), input.size());
+        currentState = result.state;
+        return result.accepted;
+    }
+
+    // Run over a whole file as one input string, split across `threads`
+    // threads (0 = all CPUs), and print ACCEPTED, REJECTED or INVALID <offset>
+    int classifyFile(const string& path, int threads) {
+        long long size = inputFileSize(path);
+        DFARun<Matcher::State> result;
+        if(size < 0 || !runFileParallel(dfa, path, threads, result)) {
+            cerr << "ERROR: Cannot read " << path << "\n";
+            return 1;
+        }
+        currentState = result.state;
+        if((long long)result.consumed < size) {
+            cout << "INVALID " << result.consumed << "\n";
+        } else {
+            cout << (result.accepted ? "ACCEPTED\n" : "REJECTED\n");
+        }
+        return 0;
     }
 
     void printFormalDefinition() {
@@ -90,8 +138,8 @@ public:
         
         for(int i = 0; i < 4; i++) {
             cout << setw(10) << "q" + to_string(i);
-            cout << setw(10) << "q" + to_string(transitionTable[i][0]);
-            cout << setw(10) << "q" + to_string(transitionTable[i][1]) << "\n";
+            cout << setw(10) << "q" + to_string(dfa.transition(i, '0'));
+            cout << setw(10) << "q" + to_string(dfa.transition(i, '1')) << "\n";
         }
         cout << "\nDESCRIPTION:\n";
         cout << "q0 = (Even 0s, Even 1s)\n";
@@ -102,9 +150,41 @@ public:
     }
 };
 
-int main() {
+int main(int argc, char* argv[]) {
     FiniteAutomata fa;
     string input;
+
+    // Options: -b <file> classifies each line of the file (ACCEPTED/REJECTED/INVALID),
+    //          -t none|summary|steps sets the trace level (default: steps, none with -b)
+    //          -f <file> [-j <threads>] runs the whole file as one string
+    string batchPath, filePath;
+    int threads = 1;
+    TraceLevel level = TRACE_STEPS;
+    bool levelGiven = false;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string option = argv[i];
+        if (option == "-b") {
+            batchPath = argv[i + 1];
+        } else if (option == "-t" && parseTraceLevel(argv[i + 1], level)) {
+            levelGiven = true;
+        } else if (option == "-f") {
+            filePath = argv[i + 1];
+        } else if (option == "-j") {
+            threads = atoi(argv[i + 1]);
+        }
+    }
+
+    if (!filePath.empty()) {
+        return fa.classifyFile(filePath, threads);
+    }
+
+    if (!batchPath.empty()) {
+        if (!levelGiven) level = TRACE_NONE;
+        return runBatch(batchPath, [&fa, level](const string& record, BufferedSink& out) {
+            if (!fa.isValidInput(record)) out << "INVALID\n";
+            else out << (fa.processString(record, out, level) ? "ACCEPTED\n" : "REJECTED\n");
+        });
+    }
     
     cout << "Finite Automata for strings with even number of 0s OR even number of 1s\n";
     cout << "Enter a string (containing only 0s and 1s): ";
@@ -115,7 +195,11 @@ int main() {
         return 1;
     }
 
-    bool accepted = fa.processString(input);
+    bool accepted;
+    {
+        BufferedSink trace(cout);
+        accepted = fa.processString(input, trace, level);
+    }
     cout << "String \"" << input << "\" is " 
          << (accepted ? "ACCEPTED" : "REJECTED") << "\n";
 
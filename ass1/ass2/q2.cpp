@@ -2,49 +2,65 @@
 #include <vector>
 #include <string>
 #include <iomanip>
+#include <cstdlib>
+#include "batch.h"
+#include "dfa.h"
+#include "palindrome.h"
+#include "trace.h"
 using namespace std;
 
+// Palindromes of a fixed length k (4 unless -k is given) over {a, b}. The
+// automaton is generated for k (see palindrome.h) and drives the traced runs.
+// Quiet runs and batch mode use the reverse-compare matcher, which gives the
+// same verdicts faster, and so do lengths whose automaton would be too large.
+
+// Largest automaton whose definition and table are printed in full
+const int PALINDROME_PRINT_LIMIT = 64;
+
 class FiniteAutomata {
 private:
-    vector<vector<int>> transitionTable;
+    size_t length;
+    string alphabet;
+    bool hasDFA;
+    TableDFA<uint16_t> dfa;             // Generated automaton, if small enough
+    vector<string> descriptions;
+    PalindromeMatcher matcher;
     int currentState;
-    vector<bool> finalStates;
-    const int TOTAL_STATES = 6;  // q0 to q5
 
 public:
-    FiniteAutomata() {
-        // Initialize transition table
-        transitionTable = vector<vector<int>>(TOTAL_STATES, vector<int>(2, -1));  // -1 indicates invalid transition
-        
-        // Transitions for input 'a' (index 0) and 'b' (index 1)
-        // First character transitions
-        transitionTable[0][0] = 1;  // q0 --a--> q1 (First char is 'a')
-        transitionTable[0][1] = 2;  // q0 --b--> q2 (First char is 'b')
-
-        // Second character transitions
-        transitionTable[1][0] = 3;  // q1 --a--> q3 (Read "aa")
-        transitionTable[1][1] = 4;  // q1 --b--> q4 (Read "ab")
-        transitionTable[2][0] = 4;  // q2 --a--> q4 (Read "ba")
-        transitionTable[2][1] = 3;  // q2 --b--> q3 (Read "bb")
-
-        // Third character transitions
-        for(int i = 3; i <= 4; i++) {
-            transitionTable[i][0] = transitionTable[i][1] = i;  // Stay in same state, just remember position
+    // The alphabet as text, e.g. "a,b" for (","), "a, b" for (", ") and
+    // "'a' and 'b'" for (", ", " and ", "'")
+    string symbolList(const string& separator = ",", const string& lastSeparator = "",
+                      const string& quote = "") {
+        string list;
+        for(size_t i = 0; i < alphabet.size(); i++) {
+            if(i) list += (i + 1 == alphabet.size() && !lastSeparator.empty()) ? lastSeparator : separator;
+            list += quote + alphabet[i] + quote;
         }
+        return list;
+    }
 
-        finalStates = vector<bool>(TOTAL_STATES, false);
-        finalStates[5] = true;  // Only q5 is final state
-        
-        currentState = 0;
+    FiniteAutomata(size_t k = 4, const string& symbols = "ab") :
+        length(k),
+        alphabet(symbols),
+        hasDFA(palindromeDFAStates(k, symbols.size()) > 0),
+        matcher(k, symbols),
+        currentState(0) {
+        if(hasDFA) {
+            dfa = palindromeDFA(k, symbols, &descriptions).build<uint16_t>();
+        }
     }
 
-    bool isValidInput(const string& input) {
-        if(input.length() != 4) {
-            cout << "\nERROR: Input string must be exactly 4 characters long!\n";
+    size_t getLength() const { return length; }
+    const string& getAlphabet() const { return alphabet; }
+
+    bool isValidInput(const string& input, bool report = true) {
+        if(input.length() != length) {
+            if(report) cout << "\nERROR: Input string must be exactly " << length << " characters long!\n";
             return false;
         }
         for(char c : input) {
-            if(c != 'a' && c != 'b') {
+            if(alphabet.find(c) == string::npos) {
                 return false;
             }
         }
@@ -52,122 +68,201 @@ public:
     }
 
     string getStateDescription(int state) {
-        switch(state) {
-            case 0: return "(Initial State)";
-            case 1: return "(Read 'a')";
-            case 2: return "(Read 'b')";
-            case 3: return "(Read aa/bb)";
-            case 4: return "(Read ab/ba)";
-            case 5: return "(Final - Palindrome)";
-            default: return "";
-        }
+        return (state >= 0 && state < (int)descriptions.size()) ? descriptions[state] : "";
     }
 
-    int getInputIndex(char c) {
-        return (c == 'a') ? 0 : 1;
-    }
+    // Run the automaton and write the requested trace to the sink. With
+    // TRACE_NONE this is the same path as accepts(): no I/O, no allocation.
+    bool processString(const string& input, BufferedSink& trace, TraceLevel level = TRACE_STEPS) {
+        if(level == TRACE_NONE) {
+            return accepts(input);
+        }
+        if(!hasDFA) {
+            return processWithMatcher(input, trace, level);
+        }
 
-    bool processFinalCharacter(const string& input) {
-        // Check if last two characters match the pattern for palindrome
-        if(currentState == 3) {  // Read aa or bb
-            if(input[0] == input[3] && input[1] == input[2]) {
-                currentState = 5;
-                return true;
-            }
+        bool steps = (level == TRACE_STEPS);
+        currentState = dfa.getStart();
+        trace << "\nTransitions:\n";
+        trace << "Initial State: q" << currentState << " " << getStateDescription(currentState) << "\n";
+        if(steps) {
+            trace.repeat('-', 50);
+            trace << "\n";
+            trace.column("Input Symbol", 15);
+            trace.column("Current State", 15);
+            trace.column("Next State", 15);
+            trace << "\n";
+            trace.repeat('-', 50);
+            trace << "\n";
         }
-        else if(currentState == 4) {  // Read ab or ba
-            if(input[0] == input[3] && input[1] == input[2]) {
-                currentState = 5;
-                return true;
+
+        auto result = dfa.run(input.data(), input.size(), dfa.getStart(), [&](size_t i, int from, int to) {
+            if(steps) {
+                trace.column(input[i], 15);
+                trace.stateColumn(from, 15);
+                trace.stateColumn(to, 15);
+                trace << "\n";
             }
+        });
+        currentState = result.state;
+        if(result.consumed != input.size()) {
+            trace << "No transition from q" << currentState << " on '" << input[result.consumed] << "'\n";
         }
-        return false;
+        if(steps) {
+            trace.repeat('-', 50);
+            trace << "\n";
+        }
+        trace << "Final State: q" << currentState << " " << getStateDescription(currentState) << "\n\n";
+
+        return result.accepted;
     }
 
-    bool processString(const string& input) {
-        currentState = 0;
-        cout << "\nTransitions:\n";
-        cout << "Initial State: q" << currentState << " " << getStateDescription(currentState) << "\n";
-        cout << string(50, '-') << "\n";
-        cout << setw(15) << "Input Symbol" << setw(15) << "Current State" 
-             << setw(15) << "Next State" << "\n";
-        cout << string(50, '-') << "\n";
-
-        // Process first three characters
-        for(int i = 0; i < 3; i++) {
-            int inputIdx = getInputIndex(input[i]);
-            int nextState = transitionTable[currentState][inputIdx];
-            
-            if(nextState == -1) {
-                cout << "Invalid transition encountered!\n";
-                return false;
+    // Trace for lengths without an automaton: the symbol pairs that are compared
+    bool processWithMatcher(const string& input, BufferedSink& trace, TraceLevel level) {
+        trace << "\nComparisons (no automaton for length " << (long long)length << "):\n";
+        bool accepted = matcher.matches(input);
+        if(level == TRACE_STEPS) {
+            trace.repeat('-', 50);
+            trace << "\n";
+            trace.column("Position", 15);
+            trace.column("Symbol", 15);
+            trace.column("Mirror", 15);
+            trace << "\n";
+            trace.repeat('-', 50);
+            trace << "\n";
+            for(size_t i = 0; i < input.size() / 2; i++) {
+                trace.column(to_string(i), 15);
+                trace.column(input[i], 15);
+                trace.column(input[input.size() - 1 - i], 15);
+                trace << "\n";
+                if(input[i] != input[input.size() - 1 - i]) break;
             }
-
-            cout << setw(15) << input[i] << setw(15) << "q" + to_string(currentState) 
-                 << setw(15) << "q" + to_string(nextState) << "\n";
-            currentState = nextState;
+            trace.repeat('-', 50);
+            trace << "\n";
         }
+        trace << (accepted ? "Reads the same backwards\n\n" : "Does not read the same backwards\n\n");
+        return accepted;
+    }
 
-        // Process last character
-        bool isAccepted = processFinalCharacter(input);
-        cout << setw(15) << input[3] << setw(15) << "q" + to_string(currentState) 
-             << setw(15) << "q" + to_string(isAccepted ? 5 : currentState) << "\n";
-        
-        cout << string(50, '-') << "\n";
-        cout << "Final State: q" << currentState << " " << getStateDescription(currentState) << "\n\n";
-        
-        return isAccepted;
+    // Same verdict as the automaton, without printing anything
+    bool accepts(const string& input) {
+        return matcher.matches(input);
     }
 
     void printFormalDefinition() {
         cout << "\nFormal Definition of the Finite Automata:\n";
-        cout << "Q = {q0, q1, q2, q3, q4, q5}, where:\n";
-        for(int i = 0; i < TOTAL_STATES; i++) {
+        if(!hasDFA || dfa.getNumStates() > PALINDROME_PRINT_LIMIT) {
+            cout << "The automaton for length " << length << " has ";
+            if(hasDFA) cout << dfa.getNumStates() << " states; not printed.\n";
+            else cout << "more than " << PALINDROME_DFA_STATE_LIMIT << " states; not built.\n";
+            cout << "   Note: Accepts palindromes of length " << length << " over {" << symbolList() << "}\n";
+            return;
+        }
+        cout << "Q = {";
+        for(int i = 0; i < dfa.getNumStates(); i++) {
+            cout << (i ? ", " : "") << "q" << i;
+        }
+        cout << "}, where:\n";
+        for(int i = 0; i < dfa.getNumStates(); i++) {
             cout << "   q" << i << " = " << getStateDescription(i) << "\n";
         }
-        cout << "\nSigma(alphabet) = {a, b}\n";
+        cout << "\nSigma(alphabet) = {" << symbolList(", ") << "}\n";
         cout << "q0 = q0 (initial state)\n";
-        cout << "F = {q5} (final state)\n";
-        cout << "   Note: Accepts palindromes of length 4 over {a,b}\n";
+        cout << "F = {" << finalStates() << "} (final state)\n";
+        cout << "   Note: Accepts palindromes of length " << length << " over {" << symbolList() << "}\n";
         cout << "Delta (Transition function) is shown in the table below:\n\n";
     }
 
+    string finalStates() {
+        string list;
+        for(int i = 0; i < dfa.getNumStates(); i++) {
+            if(dfa.isAccepting(i)) list += (list.empty() ? "q" : ", q") + to_string(i);
+        }
+        return list;
+    }
+
     void printTransitionTable() {
-        cout << setw(10) << "State" << setw(10) << "Input a" << setw(10) << "Input b\n";
-        cout << string(30, '-') << "\n";
+        if(!hasDFA || dfa.getNumStates() > PALINDROME_PRINT_LIMIT) return;
+
+        cout << setw(10) << "State";
+        // The line break is part of the last label, as in the original
+        // two-symbol table, so it takes one column of that label's width
+        for(size_t i = 0; i < alphabet.size(); i++) {
+            cout << setw(10) << string("Input ") + alphabet[i] + (i + 1 == alphabet.size() ? "\n" : "");
+        }
+        cout << string(10 * (alphabet.size() + 1), '-') << "\n";
         
-        for(int i = 0; i < TOTAL_STATES; i++) {
+        for(int i = 0; i < dfa.getNumStates(); i++) {
             cout << setw(10) << "q" + to_string(i);
-            for(int j = 0; j < 2; j++) {
-                if(transitionTable[i][j] == -1)
+            for(char symbol : dfa.getSymbols()) {
+                if(dfa.transition(i, symbol) == -1)
                     cout << setw(10) << "-";
                 else
-                    cout << setw(10) << "q" + to_string(transitionTable[i][j]);
+                    cout << setw(10) << "q" + to_string(dfa.transition(i, symbol));
             }
             cout << "\n";
         }
         cout << "\nLegend:\n";
-        for(int i = 0; i < TOTAL_STATES; i++) {
+        for(int i = 0; i < dfa.getNumStates(); i++) {
             cout << "q" << i << " = " << getStateDescription(i) << "\n";
         }
-        cout << "\nFinal state = {q5}\n";
+        cout << "\nFinal state = {" << finalStates() << "}\n";
     }
 };
 
-int main() {
-    FiniteAutomata fa;
+int main(int argc, char* argv[]) {
     string input;
+
+    // Options: -b <file> classifies each line of the file (ACCEPTED/REJECTED/INVALID),
+    //          -t none|summary|steps sets the trace level (default: steps, none with -b),
+    //          -k <length> sets the palindrome length (default 4),
+    //          -a <symbols> sets the alphabet (default ab)
+    string batchPath;
+    TraceLevel level = TRACE_STEPS;
+    bool levelGiven = false;
+    int length = 4;
+    string alphabet = "ab";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string option = argv[i];
+        if (option == "-b") {
+            batchPath = argv[i + 1];
+        } else if (option == "-t" && parseTraceLevel(argv[i + 1], level)) {
+            levelGiven = true;
+        } else if (option == "-k") {
+            length = atoi(argv[i + 1]);
+        } else if (option == "-a") {
+            alphabet = argv[i + 1];
+        }
+    }
+    if (length < 1 || alphabet.empty()) {
+        cerr << "ERROR: -k needs a positive length and -a at least one symbol\n";
+        return 1;
+    }
+    FiniteAutomata fa(length, alphabet);
+    string symbols = "{" + fa.symbolList() + "}";
+
+    if (!batchPath.empty()) {
+        if (!levelGiven) level = TRACE_NONE;
+        return runBatch(batchPath, [&fa, level](const string& record, BufferedSink& out) {
+            if (!fa.isValidInput(record, false)) out << "INVALID\n";
+            else out << (fa.processString(record, out, level) ? "ACCEPTED\n" : "REJECTED\n");
+        });
+    }
     
-    cout << "Finite Automata for palindromes of length 4 over alphabet {a,b}\n";
-    cout << "Enter a string of length 4 (using only a and b): ";
+    cout << "Finite Automata for palindromes of length " << length << " over alphabet " << symbols << "\n";
+    cout << "Enter a string of length " << length << " (using only " << fa.symbolList(", ", " and ") << "): ";
     cin >> input;
 
     if (!fa.isValidInput(input)) {
-        cout << "\nERROR: Invalid input! String should contain only 'a' and 'b' and be exactly 4 characters long.\n";
+        cout << "\nERROR: Invalid input! String should contain only " << fa.symbolList(", ", " and ", "'") << " and be exactly " << length << " characters long.\n";
         return 1;
     }
 
-    bool accepted = fa.processString(input);
+    bool accepted;
+    {
+        BufferedSink trace(cout);
+        accepted = fa.processString(input, trace, level);
+    }
     cout << "String \"" << input << "\" is " << (accepted ? "ACCEPTED" : "REJECTED") << "\n";
 
     fa.printFormalDefinition();
@@ -2,49 +2,71 @@
 #include <vector>
 #include <string>
 #include <iomanip>
+#include <cstdlib>
+#include "batch.h"
+#include "dfa.h"
+#include "static_dfa.h"
+#include "transducer.h"
+#include "trace.h"
+#include "parallel_dfa.h"
 using namespace std;
 
+// Exactly three binary digits, fixed at compile time
+struct ThreeDigitDFA {
+    static constexpr int states = 5;  // q0 to q4 (including trap state)
+    static constexpr char symbols[] = "01";
+    static constexpr int start = 0;
+    static constexpr bool partial = false;
+    static constexpr int table[states][2] = {
+        // Input 0   Input 1
+        {1, 1},     // q0 -> q1
+        {2, 2},     // q1 -> q2
+        {3, 3},     // q2 -> q3
+        {4, 4},     // q3 -> q4 (trap)
+        {4, 4},     // q4 -> q4
+    };
+    static constexpr bool accepting[states] = {false, false, false, true, false};  // Only q3 is final
+};
+
 class FiniteAutomata {
 private:
-    vector<vector<int>> transitionTable;
+    using Matcher = StaticDFA<ThreeDigitDFA>;
+    Transducer<Matcher::State> transducer;  // Runtime copy that also outputs each digit read
+    const TableDFA<Matcher::State>& dfa;    // Its automaton, used for tracing and display
     int currentState;
-    vector<bool> finalStates;
-    const int TOTAL_STATES = 5;  // q0 to q4 (including trap state)
+    BinaryValue value;                      // Value of the digits read by the last run
+    const int TOTAL_STATES = ThreeDigitDFA::states;
 
-public:
-    FiniteAutomata() {
-        // Initialize transition table (same as before)
-        transitionTable = vector<vector<int>>(TOTAL_STATES, vector<int>(2, -1));
-        
-        // Initialize transitions
-        transitionTable[0][0] = 1;  // q0 --0--> q1
-        transitionTable[0][1] = 1;  // q0 --1--> q1
-        transitionTable[1][0] = 2;  // q1 --0--> q2
-        transitionTable[1][1] = 2;  // q1 --1--> q2
-        transitionTable[2][0] = 3;  // q2 --0--> q3
-        transitionTable[2][1] = 3;  // q2 --1--> q3
-        transitionTable[3][0] = 4;  // q3 --0--> q4 (trap)
-        transitionTable[3][1] = 4;  // q3 --1--> q4 (trap)
-        transitionTable[4][0] = 4;  // q4 --0--> q4
-        transitionTable[4][1] = 4;  // q4 --1--> q4
-
-        finalStates = vector<bool>(TOTAL_STATES, false);
-        finalStates[3] = true;  // Only q3 is final state
-        
-        currentState = 0;
+    // Every transition outputs the digit it reads, so a run also computes the
+    // value of the input, whatever its length
+    static Transducer<Matcher::State> binaryTransducer() {
+        Transducer<Matcher::State> result(Matcher::builder());
+        for(int s = 0; s < ThreeDigitDFA::states; s++) {
+            result.setOutput(s, '0', 0);
+            result.setOutput(s, '1', 1);
+        }
+        return result;
+    }
+
+    static bool onlyBinaryDigits(const char* input, size_t length) {
+        for(size_t i = 0; i < length; i++) {
+            if(input[i] != '0' && input[i] != '1') return false;
+        }
+        return true;
     }
 
+public:
+    FiniteAutomata() : transducer(binaryTransducer()), dfa(transducer.automaton()), currentState(0) {}
+
     // Other helper functions remain the same
-    bool isValidInput(const string& input) {
+    bool isValidInput(const string& input, bool report = true) {
         if(input.empty()) {
-            cout << "\nERROR: Input string cannot be empty!\n";
+            if(report) cout << "\nERROR: Input string cannot be empty!\n";
             return false;
         }
-        for(char c : input) {
-            if(c != '0' && c != '1') {
-                cout << "\nERROR: Input string must contain only 0's and 1's!\n";
-                return false;
-            }
+        if(!onlyBinaryDigits(input.data(), input.size())) {
+            if(report) cout << "\nERROR: Input string must contain only 0's and 1's!\n";
+            return false;
         }
         return true;
     }
@@ -64,37 +86,103 @@ public:
         return "q" + to_string(fromState) + " --" + input + "--> q" + to_string(toState);
     }
 
-    int getInputIndex(char c) {
-        return (c == '0') ? 0 : 1;
-    }
+    // Run the automaton and write the requested trace to the sink; either way
+    // the same pass computes the value for getDecimalValue(). With TRACE_NONE
+    // this is the transducer loop: no I/O, and no allocation below 64 digits.
+    // The path string is only built for TRACE_STEPS, which prints it.
+    bool processString(const string& input, BufferedSink& trace, TraceLevel level = TRACE_STEPS) {
+        if(level == TRACE_NONE) {
+            return evaluate(input).accepted;
+        }
 
-    bool processString(const string& input) {
+        bool steps = (level == TRACE_STEPS);
         currentState = 0;
-        cout << "\nDetailed Transition Path:\n";
-        cout << string(60, '=') << "\n";
-        cout << "Start: q0 " << getStateDescription(0) << "\n\n";
-
-        string currentPath = "Path: q0";
-        for(char digit : input) {
-            int inputIdx = getInputIndex(digit);
-            int nextState = transitionTable[currentState][inputIdx];
+        value.clear();
+        trace << "\nDetailed Transition Path:\n";
+        trace.repeat('=', 60);
+        trace << "\n";
+        trace << "Start: q0 " << getStateDescription(0) << "\n\n";
+
+        string currentPath;
+        if(steps) {
+            currentPath.reserve(8 + 6 * input.size());
+            currentPath = "Path: q0";
+        }
+        auto result = dfa.run(input.data(), input.size(), dfa.getStart(), [&](size_t i, int from, int to) {
+            char digit = input[i];
+            uint8_t bit = transducer.output(from, digit);
+            if(bit != NO_OUTPUT) value.push(bit);
+            if(!steps) return;
             
             // Show transition arrow and state information
-            cout << getTransitionArrow(digit, currentState, nextState) << "\n";
-            cout << "Current configuration: " << currentPath << "\n";
-            cout << "Reading: " << digit << "\n";
-            cout << "Moving to: q" << nextState << " " << getStateDescription(nextState) << "\n";
-            cout << string(40, '-') << "\n";
+            trace << "q" << from << " --" << digit << "--> q" << to << "\n";
+            trace << "Current configuration: " << currentPath << "\n";
+            trace << "Reading: " << digit << "\n";
+            trace << "Moving to: q" << to << " " << getStateDescription(to) << "\n";
+            trace.repeat('-', 40);
+            trace << "\n";
             
-            currentState = nextState;
-            currentPath += " -> q" + to_string(nextState);
-        }
+            currentPath += " -> q";
+            currentPath += to_string(to);
+        });
+        currentState = result.state;
         
-        cout << "\nFinal Path: " << currentPath << "\n";
-        cout << "Ended in: q" << currentState << " " << getStateDescription(currentState) << "\n";
-        cout << string(60, '=') << "\n\n";
+        if(steps) {
+            trace << "\nFinal Path: " << currentPath << "\n";
+        }
+        trace << "Ended in: q" << currentState << " " << getStateDescription(currentState) << "\n";
+        trace.repeat('=', 60);
+        trace << "\n\n";
         
-        return finalStates[currentState];
+        return result.accepted;
+    }
+
+    // One pass that runs the automaton and computes the value of the digits
+    // read. Like decide(), it stops once the trap state makes the verdict final.
+    DFARun<Matcher::State> evaluate(const string& input) {
+        value.clear();
+        auto result = transducer.transduce(input, [this](uint8_t bit) { value.push(bit); });
+        currentState = result.state;
+        return result;
+    }
+
+    // Batch result for one record with TRACE_NONE: the run checks the digits
+    // and computes the value as it goes. After the trap state ends it early,
+    // only the rest of the record still needs the alphabet check.
+    void classifyRecord(const string& record, BufferedSink& out) {
+        auto result = evaluate(record);
+        if(record.empty() || !onlyBinaryDigits(record.data() + result.consumed, record.size() - result.consumed)) {
+            out << "INVALID\n";
+        } else if(result.accepted) {
+            out << "ACCEPTED " << value.toString() << "\n";
+        } else {
+            out << "REJECTED\n";
+        }
+    }
+
+    // Run the automaton without printing anything
+    bool accepts(const string& input) {
+        auto result = Matcher::decide(input.data(), input.size());
+        currentState = result.state;
+        return result.accepted;
+    }
+
+    // Run over a whole file as one input string, split across `threads`
+    // threads (0 = all CPUs), and print ACCEPTED, REJECTED or INVALID <offset>
+    int classifyFile(const string& path, int threads) {
+        long long size = inputFileSize(path);
+        DFARun<Matcher::State> result;
+        if(size < 0 || !runFileParallel(dfa, path, threads, result)) {
+            cerr << "ERROR: Cannot read " << path << "\n";
+            return 1;
+        }
+        currentState = result.state;
+        if((long long)result.consumed < size) {
+            cout << "INVALID " << result.consumed << "\n";
+        } else {
+            cout << (result.accepted ? "ACCEPTED\n" : "REJECTED\n");
+        }
+        return 0;
     }
 
     void printFormalDefinition() {
@@ -125,8 +213,8 @@ public:
         for(int i = 0; i < TOTAL_STATES; i++) {
             cout << left << setw(8) << ("q" + to_string(i))
                  << setw(35) << getStateDescription(i)
-                 << setw(12) << ("q" + to_string(transitionTable[i][0]))
-                 << setw(12) << ("q" + to_string(transitionTable[i][1]))
+                 << setw(12) << ("q" + to_string(dfa.transition(i, '0')))
+                 << setw(12) << ("q" + to_string(dfa.transition(i, '1')))
                  << "\n";
         }
         
@@ -136,22 +224,59 @@ public:
         cout << "Valid transitions for each state:\n";
         for(int i = 0; i < TOTAL_STATES; i++) {
             cout << "From q" << i << ": ";
-            cout << getTransitionArrow('0', i, transitionTable[i][0]) << ", ";
-            cout << getTransitionArrow('1', i, transitionTable[i][1]) << "\n";
+            cout << getTransitionArrow('0', i, dfa.transition(i, '0')) << ", ";
+            cout << getTransitionArrow('1', i, dfa.transition(i, '1')) << "\n";
         }
     }
 
-    int getDecimalValue(const string& binary) {
-        if(binary.length() == 3) {
-            return stoi(binary, nullptr, 2);
-        }
-        return -1;
+    // Value of the digits read by the last processString, any number of them
+    string getDecimalValue() const {
+        return value.toString();
     }
 };
 
-int main() {
+int main(int argc, char* argv[]) {
     FiniteAutomata fa;
     string input;
+
+    // Options: -b <file> classifies each line of the file (ACCEPTED <value>/REJECTED/INVALID),
+    //          -t none|summary|steps sets the trace level (default: steps, none with -b)
+    //          -f <file> [-j <threads>] runs the whole file as one string
+    string batchPath, filePath;
+    int threads = 1;
+    TraceLevel level = TRACE_STEPS;
+    bool levelGiven = false;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string option = argv[i];
+        if (option == "-b") {
+            batchPath = argv[i + 1];
+        } else if (option == "-t" && parseTraceLevel(argv[i + 1], level)) {
+            levelGiven = true;
+        } else if (option == "-f") {
+            filePath = argv[i + 1];
+        } else if (option == "-j") {
+            threads = atoi(argv[i + 1]);
+        }
+    }
+
+    if (!filePath.empty()) {
+        return fa.classifyFile(filePath, threads);
+    }
+
+    if (!batchPath.empty()) {
+        if (!levelGiven) level = TRACE_NONE;
+        return runBatch(batchPath, [&fa, level](const string& record, BufferedSink& out) {
+            if (level == TRACE_NONE) {
+                fa.classifyRecord(record, out);
+            } else if (!fa.isValidInput(record, false)) {
+                out << "INVALID\n";
+            } else if (fa.processString(record, out, level)) {
+                out << "ACCEPTED " << fa.getDecimalValue() << "\n";
+            } else {
+                out << "REJECTED\n";
+            }
+        });
+    }
     
     cout << "===== Finite Automata for 3-digit Binary Numbers =====\n";
     cout << "This FA accepts ONLY 3-digit binary numbers.\n";
@@ -164,11 +289,15 @@ int main() {
         return 1;
     }
 
-    bool accepted = fa.processString(input);
+    bool accepted;
+    {
+        BufferedSink trace(cout);
+        accepted = fa.processString(input, trace, level);
+    }
     cout << "Result: String \"" << input << "\" is " << (accepted ? "ACCEPTED" : "REJECTED") << "\n";
     
     if (accepted) {
-        cout << "Decimal value: " << fa.getDecimalValue(input) << "\n";
+        cout << "Decimal value: " << fa.getDecimalValue() << "\n";
     }
 
     fa.printFormalDefinition();
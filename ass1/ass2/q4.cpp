@@ -3,56 +3,125 @@
 #include <string>
 #include <algorithm>
 #include <iomanip>
+#include "language.h"
+#include "dawg.h"
+#include "language_set.h"
+#include "language_nfa.h"
 
 using namespace std;
 
-// Function to compute union of two sets
-vector<string> computeUnion(const vector<string>& A, const vector<string>& B) {
-    vector<string> result;
-    result.insert(result.end(), A.begin(), A.end());
-    result.insert(result.end(), B.begin(), B.end());
-    
-    // Remove duplicates if any
-    sort(result.begin(), result.end());
-    result.erase(unique(result.begin(), result.end()), result.end());
-    return result;
+// Function to compute union of two sets, sorted and without duplicates
+// (language_set.h sorts and merges on all cores for large sets)
+Language computeUnion(const Language& A, const Language& B) {
+    return sortedUnion(A, B);
 }
 
-// Function to compute concatenation of two sets
-vector<string> computeConcatenation(const vector<string>& A, const vector<string>& B) {
-    vector<string> result;
-    for(const auto& a : A) {
-        for(const auto& b : B) {
-            result.push_back(a + b);
+// Words in both sets, sorted
+Language computeIntersection(const Language& A, const Language& B) {
+    return sortedIntersection(A, B);
+}
+
+// Words of A that are not in B, sorted
+Language computeDifference(const Language& A, const Language& B) {
+    return sortedDifference(A, B);
+}
+
+// Function to compute concatenation of two sets. The result's size is known
+// up front, so the arena is allocated once and every a + b written into it.
+Language computeConcatenation(const Language& A, const Language& B) {
+    Language result;
+    result.reserve(A.size() * B.size(), A.byteSize() * B.size() + B.byteSize() * A.size());
+    for(string_view a : A) {
+        for(string_view b : B) {
+            result.pushConcat(a, b);
         }
     }
     return result;
 }
 
-// Function to compute (BA)* up to n iterations
-vector<string> computeBAstar(const vector<string>& B, const vector<string>& A, int n) {
-    vector<string> result = {""};  // Empty string is always part of Kleene star
-    vector<string> BA = computeConcatenation(B, A);
-    
-    vector<string> current = BA;
-    for(int i = 1; i <= n; i++) {
-        // Add current iteration to result
-        result.insert(result.end(), current.begin(), current.end());
-        
-        // Compute next iteration
-        vector<string> next;
-        for(const auto& str : current) {
-            for(const auto& ba : BA) {
-                next.push_back(str + ba);
-            }
+// Words of (BA)* up to n iterations, one at a time and in the order
+// computeBAstar lists them: the empty word, then iteration 1, 2, ..., n, and
+// within an iteration by the indices into BA with the last varying fastest.
+// The state is an odometer of at most n indices plus the current word, so
+// memory stays O(n) however many words there are.
+class BAStarEnumerator {
+private:
+    Language BA;
+    int maxIterations;
+    vector<size_t> digits;      // Index into BA of each part of the current word
+    vector<size_t> offsets;     // Where each part starts in `word`
+    string word;
+    bool finished;
+
+    // Rebuild the word from part `from` on, after digits[from..] changed
+    void rebuildFrom(size_t from) {
+        word.resize(offsets[from]);
+        for(size_t j = from; j < digits.size(); j++) {
+            offsets[j] = word.size();
+            word += BA[digits[j]];
         }
-        current = next;
+    }
+
+public:
+    BAStarEnumerator(const Language& B, const Language& A, int n) :
+        BA(computeConcatenation(B, A)), maxIterations(n), finished(false) {}
+
+    bool done() const { return finished; }
+    const string& current() const { return word; }
+
+    // Step to the next word, or set done() after the last one
+    void advance() {
+        size_t j = digits.size();
+        while(j > 0 && digits[j - 1] + 1 == BA.size()) j--;
+        if(j > 0) {
+            // Bump one digit and reset the ones after it, like an odometer
+            digits[j - 1]++;
+            fill(digits.begin() + j, digits.end(), 0);
+            rebuildFrom(j - 1);
+            return;
+        }
+        // Every digit rolled over: start the next iteration
+        if(BA.empty() || (int)digits.size() >= maxIterations) {
+            finished = true;
+            return;
+        }
+        digits.assign(digits.size() + 1, 0);
+        offsets.assign(digits.size(), 0);
+        rebuildFrom(0);
+    }
+};
+
+// Function to compute (BA)* up to n iterations
+Language computeBAstar(const Language& B, const Language& A, int n) {
+    Language result;
+    for(BAStarEnumerator words(B, A, n); !words.done(); words.advance()) {
+        result.push_back(words.current());
+    }
+    return result;
+}
+
+// (BA)* up to n iterations as a DAWG: each power is the one before times BA,
+// and the powers are merged with union. Holds the same words as computeBAstar
+// (iterated in sorted order) in a few nodes per iteration, so it stays small
+// long after the word list would not fit in memory.
+DAWG computeBAstarCompressed(const Language& B, const Language& A, int n) {
+    DAWG BA(computeConcatenation(B, A));
+    DAWG power(Language{""});
+    DAWG result = power;
+    for(int i = 1; i <= n && !BA.empty(); i++) {
+        power = DAWG::computeConcatenation(power, BA);
+        result = DAWG::computeUnion(result, power);
     }
     return result;
 }
 
+// (BA)* as an automaton, for membership queries that never enumerate it
+LanguageNFA buildBAstarNFA(const Language& B, const Language& A) {
+    return LanguageNFA::star(LanguageNFA::concatenation(LanguageNFA::words(B), LanguageNFA::words(A)));
+}
+
 // Function to print a set with proper formatting
-void printSet(const string& setName, const vector<string>& set) {
+void printSet(const string& setName, const Language& set) {
     cout << setName << " = { ";
     for(size_t i = 0; i < set.size(); i++) {
         cout << set[i];
@@ -61,10 +130,40 @@ void printSet(const string& setName, const vector<string>& set) {
     cout << " }" << endl;
 }
 
-int main() {
+// Same format as printSet, writing each word of (BA)* as it is produced
+void printBAstar(const string& setName, const Language& B, const Language& A, int n) {
+    cout << setName << " = { ";
+    for(BAStarEnumerator words(B, A, n); !words.done(); ) {
+        cout << words.current();
+        words.advance();
+        if(!words.done()) cout << ", ";
+    }
+    cout << " }" << endl;
+}
+
+int main(int argc, char* argv[]) {
     // Define sets A and B
-    vector<string> A = {"big", "small"};
-    vector<string> B = {"long", "short"};
+    Language A = {"big", "small"};
+    Language B = {"long", "short"};
+
+    // Option: -m <word> [-m <word> ...] only answers whether each word is in
+    //         A U B, A o B and (BA)*, using automata instead of the word lists
+    vector<string> queries;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (string(argv[i]) == "-m") queries.push_back(argv[i + 1]);
+    }
+    if (!queries.empty()) {
+        LanguageNFA setA = LanguageNFA::words(A), setB = LanguageNFA::words(B);
+        LanguageNFA unionNFA = LanguageNFA::alternation(setA, setB);
+        LanguageNFA concatNFA = LanguageNFA::concatenation(setA, setB);
+        LanguageNFA starNFA = buildBAstarNFA(B, A);
+        for (const string& word : queries) {
+            cout << "\"" << word << "\": A U B " << (unionNFA.contains(word) ? "yes" : "no")
+                 << ", A o B " << (concatNFA.contains(word) ? "yes" : "no")
+                 << ", (BA)* " << (starNFA.contains(word) ? "yes" : "no") << "\n";
+        }
+        return 0;
+    }
     
     // Print original sets
     cout << "\nOriginal Sets:" << endl;
@@ -75,13 +174,13 @@ int main() {
     // i) Compute and print A U B
     cout << "\ni) A U B (Union):" << endl;
     cout << "----------------" << endl;
-    vector<string> unionResult = computeUnion(A, B);
+    Language unionResult = computeUnion(A, B);
     printSet("A U B", unionResult);
     
     // ii) Compute and print A o B (Concatenation)
     cout << "\nii) A o B (Concatenation):" << endl;
     cout << "------------------------" << endl;
-    vector<string> concatResult = computeConcatenation(A, B);
+    Language concatResult = computeConcatenation(A, B);
     printSet("A o B", concatResult);
     
     // iii) Compute and print (BA)*
@@ -91,9 +190,8 @@ int main() {
     cout << "Enter the number of iterations for (BA)*: ";
     cin >> n;
     
-    vector<string> baStarResult = computeBAstar(B, A, n);
     cout << "\nComputing (BA)* up to " << n << " iterations:" << endl;
-    printSet("(BA)*", baStarResult);
+    printBAstar("(BA)*", B, A, n);
     
     return 0;
 }
\ No newline at end of file
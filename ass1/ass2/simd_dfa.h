@@ -0,0 +1,84 @@
+#ifndef SIMD_DFA_H
+#define SIMD_DFA_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_DFA_X86 1
+#include <immintrin.h>
+#endif
+
+// Shuffle kernel for automata with at most 15 states (plus one dead state).
+// `lanes` holds 16 current states, typically "where each possible start state
+// has got to". `columns` has 16 bytes per input byte value: columns[16 * b + s]
+// is the state reached from s on byte b, with the dead state absorbing. One
+// input symbol is then one byte shuffle of the column by the lanes.
+const int SHUFFLE_LANES = 16;
+
+inline void shuffleAdvanceScalar(const uint8_t* columns, uint8_t* lanes, int usedLanes,
+                                 const char* input, size_t length) {
+    for(size_t i = 0; i < length; i++) {
+        const uint8_t* column = columns + SHUFFLE_LANES * (unsigned char)input[i];
+        for(int j = 0; j < usedLanes; j++) {
+            lanes[j] = column[lanes[j]];
+        }
+    }
+}
+
+#ifdef SIMD_DFA_X86
+
+__attribute__((target("ssse3")))
+inline void shuffleAdvanceSSSE3(const uint8_t* columns, uint8_t* lanes, const char* input, size_t length) {
+    __m128i state = _mm_loadu_si128((const __m128i*)lanes);
+    size_t i = 0;
+    for(; i + 4 <= length; i += 4) {
+        __m128i c0 = _mm_loadu_si128((const __m128i*)(columns + SHUFFLE_LANES * (unsigned char)input[i]));
+        __m128i c1 = _mm_loadu_si128((const __m128i*)(columns + SHUFFLE_LANES * (unsigned char)input[i + 1]));
+        __m128i c2 = _mm_loadu_si128((const __m128i*)(columns + SHUFFLE_LANES * (unsigned char)input[i + 2]));
+        __m128i c3 = _mm_loadu_si128((const __m128i*)(columns + SHUFFLE_LANES * (unsigned char)input[i + 3]));
+        state = _mm_shuffle_epi8(c0, state);
+        state = _mm_shuffle_epi8(c1, state);
+        state = _mm_shuffle_epi8(c2, state);
+        state = _mm_shuffle_epi8(c3, state);
+    }
+    for(; i < length; i++) {
+        __m128i c = _mm_loadu_si128((const __m128i*)(columns + SHUFFLE_LANES * (unsigned char)input[i]));
+        state = _mm_shuffle_epi8(c, state);
+    }
+    _mm_storeu_si128((__m128i*)lanes, state);
+}
+
+inline bool shuffleKernelSupported() {
+    static const bool supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("ssse3") != 0;
+    }();
+    return supported;
+}
+
+#endif // SIMD_DFA_X86
+
+// True when shuffleAdvance runs as a vector kernel rather than the scalar loop
+inline bool shuffleKernelFast() {
+#ifdef SIMD_DFA_X86
+    return shuffleKernelSupported();
+#else
+    return false;
+#endif
+}
+
+// Advance all lanes over input[0..length), with the SSSE3 shuffle when the CPU has it
+inline void shuffleAdvance(const uint8_t* columns, uint8_t* lanes, int usedLanes,
+                           const char* input, size_t length) {
+#ifdef SIMD_DFA_X86
+    if(shuffleKernelSupported()) {
+        shuffleAdvanceSSSE3(columns, lanes, input, length);
+        return;
+    }
+#endif
+    shuffleAdvanceScalar(columns, lanes, usedLanes, input, length);
+}
+
+#endif // SIMD_DFA_H
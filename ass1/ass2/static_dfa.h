@@ -0,0 +1,230 @@
+#ifndef STATIC_DFA_H
+#define STATIC_DFA_H
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include "dfa.h"
+using namespace std;
+
+// DFA fixed at build time. Def is a struct of constexpr members:
+//
+//   struct ParityDFA {
+//       static constexpr int states = 4;
+//       static constexpr char symbols[] = "01";       // column i reads symbols[i]
+//       static constexpr int start = 0;
+//       static constexpr bool partial = false;        // true allows -1 entries
+//       static constexpr int table[states][2] = {{2, 1}, {3, 0}, {0, 3}, {1, 2}};
+//       static constexpr bool accepting[states] = {true, true, true, false};
+//   };
+//
+// StaticDFA<Def> checks the definition at compile time (every target in range,
+// no missing transitions unless Def::partial) and builds its tables as
+// constants, including the verdict of every state (see computeVerdicts) so
+// decide() can stop in a dead state or accepting sink. Automata with fewer
+// than 8 states are packed into one 64-bit word per input column, so a step
+// is a shift and a mask on the current state with no table load on the
+// dependency chain.
+
+// Compile-time checks and table builders behind StaticDFA
+
+template <typename Def>
+constexpr int staticDFAClasses() { return sizeof(Def::symbols) - 1; }
+
+template <typename Def>
+constexpr bool staticDFATargetsInRange() {
+    for(int s = 0; s < Def::states; s++) {
+        for(int c = 0; c < staticDFAClasses<Def>(); c++) {
+            if(Def::table[s][c] < -1 || Def::table[s][c] >= Def::states) return false;
+        }
+    }
+    return Def::start >= 0 && Def::start < Def::states;
+}
+
+template <typename Def>
+constexpr bool staticDFAComplete() {
+    for(int s = 0; s < Def::states; s++) {
+        for(int c = 0; c < staticDFAClasses<Def>(); c++) {
+            if(Def::table[s][c] == -1) return false;
+        }
+    }
+    return true;
+}
+
+template <typename Def>
+constexpr bool staticDFASymbolsDistinct() {
+    for(int i = 0; i < staticDFAClasses<Def>(); i++) {
+        for(int j = i + 1; j < staticDFAClasses<Def>(); j++) {
+            if(Def::symbols[i] == Def::symbols[j]) return false;
+        }
+    }
+    return true;
+}
+
+template <typename Def>
+constexpr array<uint8_t, 256> staticDFAClassMap() {
+    array<uint8_t, 256> classOf{};
+    for(int i = 0; i < 256; i++) classOf[i] = staticDFAClasses<Def>();
+    for(int c = 0; c < staticDFAClasses<Def>(); c++) classOf[(unsigned char)Def::symbols[c]] = c;
+    return classOf;
+}
+
+// Entry for state s and column c, with the extra invalid-symbol column as -1
+template <typename Def>
+constexpr int staticDFAEntry(int s, int c) {
+    return (c < staticDFAClasses<Def>()) ? Def::table[s][c] : -1;
+}
+
+template <typename Def, typename State, size_t Size>
+constexpr array<State, Size> staticDFATable() {
+    const int columns = staticDFAClasses<Def>() + 1;
+    array<State, Size> table{};
+    for(int s = 0; s < Def::states; s++) {
+        for(int c = 0; c < columns; c++) {
+            int to = staticDFAEntry<Def>(s, c);
+            table[(size_t)s * columns + c] = (to == -1) ? TableDFA<State>::NONE : (State)to;
+        }
+    }
+    return table;
+}
+
+template <typename Def>
+constexpr array<uint8_t, Def::states> staticDFAVerdicts() {
+    array<uint8_t, Def::states> verdict{};
+    computeVerdicts(Def::states, staticDFAClasses<Def>(),
+        [](int state, int column) { return Def::table[state][column]; },
+        [](int state) { return Def::accepting[state]; }, verdict);
+    return verdict;
+}
+
+template <typename Def>
+constexpr bool staticDFAHasDecidedStates() {
+    array<uint8_t, Def::states> verdict = staticDFAVerdicts<Def>();
+    for(int s = 0; s < Def::states; s++) {
+        if(verdict[s] != VERDICT_OPEN) return true;
+    }
+    return false;
+}
+
+// Packed form for automata with fewer than 8 states: one 64-bit word per
+// column, byte s holding 8 * (next state of s). NONE is state Def::states,
+// whose byte points back to itself.
+template <typename Def, size_t Columns>
+constexpr array<uint64_t, Columns> staticDFAPackedColumns() {
+    array<uint64_t, Columns> words{};
+    if(Def::states < 8) {
+        for(size_t c = 0; c < Columns; c++) {
+            for(int s = 0; s <= Def::states; s++) {
+                int to = (s < Def::states) ? staticDFAEntry<Def>(s, c) : -1;
+                uint64_t entry = 8 * (uint64_t)((to == -1) ? Def::states : to);
+                words[c] |= entry << (8 * s);
+            }
+        }
+    }
+    return words;
+}
+
+// The matcher itself; see the comment at the top of the file
+template <typename Def>
+class StaticDFA {
+public:
+    static constexpr int numStates = Def::states;
+    static constexpr int numClasses = staticDFAClasses<Def>();
+    using State = StateTypeFor<numStates>;
+    static constexpr State NONE = TableDFA<State>::NONE;
+
+    static_assert(numStates > 0 && numClasses > 0, "StaticDFA: empty automaton");
+    static_assert(staticDFASymbolsDistinct<Def>(), "StaticDFA: repeated input symbol");
+    static_assert(staticDFATargetsInRange<Def>(), "StaticDFA: transition or start state out of range");
+    static_assert(Def::partial || staticDFAComplete<Def>(), "StaticDFA: missing transition in a DFA not declared partial");
+
+private:
+    static constexpr int columns = numClasses + 1;     // Last column: invalid symbols
+
+public:
+    static constexpr bool packed = numStates < 8;
+
+private:
+    static constexpr array<uint8_t, 256> classOf = staticDFAClassMap<Def>();
+    static constexpr array<State, (size_t)numStates * columns> table =
+        staticDFATable<Def, State, (size_t)numStates * columns>();
+    static constexpr array<uint64_t, columns> packedColumns = staticDFAPackedColumns<Def, columns>();
+    static constexpr array<uint8_t, numStates> verdicts = staticDFAVerdicts<Def>();
+
+public:
+    // Some state is dead or an accepting sink, so decide() can stop early
+    static constexpr bool hasDecidedStates = staticDFAHasDecidedStates<Def>();
+
+    // Single step; NONE if there is no transition or c is not in the alphabet
+    static constexpr State step(State state, char c) {
+        unsigned column = classOf[(unsigned char)c];
+        if(packed) {
+            unsigned next = (unsigned)(packedColumns[column] >> (8 * state)) & 0xFF;
+            return next == 8u * numStates ? NONE : (State)(next / 8);
+        }
+        return table[(size_t)state * columns + column];
+    }
+
+    static constexpr bool isAccepting(int state) { return Def::accepting[state]; }
+
+    static constexpr DFARun<State> run(const char* input, size_t length) {
+        size_t i = 0;
+        if(packed) {
+            // Keep the state as its bit offset (8 * state) so each step is shift + mask
+            unsigned offset = 8u * Def::start;
+            for(; i < length; i++) {
+                unsigned next = (unsigned)(packedColumns[classOf[(unsigned char)input[i]]] >> offset) & 0xFF;
+                if(next == 8u * numStates) break;
+                offset = next;
+            }
+            State state = (State)(offset / 8);
+            return DFARun<State>{state, i, i == length && Def::accepting[state]};
+        }
+
+        State state = (State)Def::start;
+        for(; i < length; i++) {
+            State next = table[(size_t)state * columns + classOf[(unsigned char)input[i]]];
+            if(next == NONE) break;
+            state = next;
+        }
+        return DFARun<State>{state, i, i == length && Def::accepting[state]};
+    }
+
+    static constexpr Verdict getVerdict(int state) { return (Verdict)verdicts[state]; }
+
+    // Like run, but stops once the verdict no longer depends on the rest of the
+    // input; see TableDFA::decide
+    static constexpr DFARun<State> decide(const char* input, size_t length) {
+        if(!hasDecidedStates) return run(input, length);
+
+        State state = (State)Def::start;
+        size_t i = 0;
+        for(; i < length && verdicts[state] == VERDICT_OPEN; i++) {
+            State next = step(state, input[i]);
+            if(next == NONE) return DFARun<State>{state, i, false};
+            state = next;
+        }
+        bool accepted = (verdicts[state] == VERDICT_OPEN) ? Def::accepting[state] : verdicts[state] == VERDICT_ACCEPT;
+        return DFARun<State>{state, i, accepted};
+    }
+
+    static bool accepts(const string& input) {
+        return decide(input.data(), input.size()).accepted;
+    }
+
+    // Runtime copy of the same automaton, for display, tracing and the table engines
+    static DFABuilder builder() {
+        DFABuilder result(numStates, string(Def::symbols, numClasses));
+        for(int s = 0; s < numStates; s++) {
+            for(int c = 0; c < numClasses; c++) {
+                result.setTransition(s, Def::symbols[c], Def::table[s][c]);
+            }
+            result.setAccepting(s, Def::accepting[s]);
+        }
+        result.setStart(Def::start);
+        return result;
+    }
+};
+
+#endif // STATIC_DFA_H
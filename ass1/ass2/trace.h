@@ -0,0 +1,90 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <string>
+using namespace std;
+
+// How much of a run the automata programs write out
+enum TraceLevel {
+    TRACE_NONE,     // Verdict only, no I/O inside the run
+    TRACE_SUMMARY,  // Initial and final state
+    TRACE_STEPS     // One row per input symbol
+};
+
+// Parse "none", "summary" or "steps"; returns false for anything else
+inline bool parseTraceLevel(const string& name, TraceLevel& level) {
+    if(name == "none") level = TRACE_NONE;
+    else if(name == "summary") level = TRACE_SUMMARY;
+    else if(name == "steps") level = TRACE_STEPS;
+    else return false;
+    return true;
+}
+
+// Output buffer in front of an ostream. Text is appended to one string that is
+// written out whenever it passes `limit` bytes and when the sink is destroyed.
+// Numbers and padded columns are formatted in place, without temporaries.
+class BufferedSink {
+private:
+    ostream& out;
+    string buffer;
+    size_t limit;
+
+    void append(const char* text, size_t length) {
+        buffer.append(text, length);
+        if(buffer.size() >= limit) flush();
+    }
+
+    void pad(const char* text, size_t length, size_t width, bool left) {
+        size_t fill = length < width ? width - length : 0;
+        if(!left) buffer.append(fill, ' ');
+        append(text, length);
+        if(left) buffer.append(fill, ' ');
+    }
+
+public:
+    explicit BufferedSink(ostream& os, size_t bufferLimit = 1 << 16) : out(os), limit(bufferLimit) {
+        buffer.reserve(bufferLimit + 256);
+    }
+
+    ~BufferedSink() { flush(); }
+
+    BufferedSink(const BufferedSink&) = delete;
+    BufferedSink& operator=(const BufferedSink&) = delete;
+
+    void flush() {
+        out.write(buffer.data(), buffer.size());
+        out.flush();
+        buffer.clear();
+    }
+
+    BufferedSink& operator<<(const char* text) { append(text, strlen(text)); return *this; }
+    BufferedSink& operator<<(const string& text) { append(text.data(), text.size()); return *this; }
+    BufferedSink& operator<<(char c) { append(&c, 1); return *this; }
+
+    BufferedSink& operator<<(long long value) {
+        char digits[24];
+        char* end = to_chars(digits, digits + sizeof(digits), value).ptr;
+        append(digits, end - digits);
+        return *this;
+    }
+    BufferedSink& operator<<(int value) { return *this << (long long)value; }
+
+    // Write text padded to `width` characters: right-aligned like setw, or left-aligned
+    void column(const char* text, size_t width, bool left = false) { pad(text, strlen(text), width, left); }
+    void column(const string& text, size_t width, bool left = false) { pad(text.data(), text.size(), width, left); }
+    void column(char c, size_t width, bool left = false) { pad(&c, 1, width, left); }
+
+    // State name "q<n>" as a padded column
+    void stateColumn(int state, size_t width, bool left = false) {
+        char name[24] = "q";
+        char* end = to_chars(name + 1, name + sizeof(name), state).ptr;
+        pad(name, end - name, width, left);
+    }
+
+    void repeat(char c, size_t count) { buffer.append(count, c); }
+};
+
+#endif // TRACE_H
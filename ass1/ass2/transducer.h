@@ -0,0 +1,159 @@
+#ifndef TRANSDUCER_H
+#define TRANSDUCER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "dfa.h"
+using namespace std;
+
+// Mealy-style output on top of a TableDFA: every transition can carry an
+// output code, and transduce() hands the codes to a sink while it runs the
+// automaton, so checking a string and computing something from it (a value,
+// a count, a translation) is one pass over the input.
+
+// Output code of a transition that produces nothing
+const uint8_t NO_OUTPUT = 0xFF;
+
+template <typename State>
+class Transducer {
+public:
+    static const State NONE = TableDFA<State>::NONE;
+
+private:
+    TableDFA<State> dfa;
+    int columns;                // Alphabet size plus the invalid-symbol column
+    vector<uint8_t> outputs;    // Row-major like the transition table, NO_OUTPUT by default
+
+public:
+    explicit Transducer(const DFABuilder& builder) :
+        dfa(builder),
+        columns(dfa.getNumClasses() + 1),
+        outputs((size_t)dfa.getNumStates() * columns, NO_OUTPUT) {}
+
+    void setOutput(int from, char symbol, uint8_t code) {
+        int column = dfa.classOfSymbol(symbol);
+        if(from < 0 || from >= dfa.getNumStates() || column == dfa.getNumClasses()) {
+            throw invalid_argument("Transducer: output out of range");
+        }
+        outputs[(size_t)from * columns + column] = code;
+    }
+
+    const TableDFA<State>& automaton() const { return dfa; }
+
+    // Output of the transition from `from` on c, NO_OUTPUT if it has none
+    uint8_t output(int from, char c) const {
+        return outputs[(size_t)from * columns + dfa.classOfSymbol(c)];
+    }
+
+    // Run from `from` and call sink(code) for the output of every transition
+    // taken. Stops at a missing transition, and also on entering a dead state
+    // (like TableDFA::decide), since a rejected run's output is never used;
+    // in that case the symbols after `consumed` have not been checked.
+    template <typename Sink>
+    DFARun<State> transduce(const char* input, size_t length, State from, Sink sink) const {
+        State state = from;
+        size_t i = 0;
+        for(; i < length && dfa.getVerdict(state) != VERDICT_REJECT; i++) {
+            State next = dfa.step(state, input[i]);
+            if(next == NONE) break;
+            uint8_t code = outputs[(size_t)state * columns + dfa.classOfSymbol(input[i])];
+            if(code != NO_OUTPUT) sink(code);
+            state = next;
+        }
+        return DFARun<State>{state, i, i == length && dfa.isAccepting(state)};
+    }
+
+    template <typename Sink>
+    DFARun<State> transduce(const string& input, Sink sink) const {
+        return transduce(input.data(), input.size(), dfa.getStart(), sink);
+    }
+};
+
+template <typename State>
+const State Transducer<State>::NONE;
+
+// Value of a binary numeral fed one digit at a time, most significant first,
+// for any number of digits. It stays a plain 64-bit integer while it fits;
+// past that the digits are kept packed in 32-bit words, so each digit is
+// still O(1) and only toString pays for the base conversion.
+class BinaryValue {
+private:
+    vector<uint32_t> words;     // High digits, most significant word first
+    uint64_t tail;              // Digits after `words`
+    int tailBits;               // Digits in `tail`, below 64 once words is non-empty
+
+public:
+    BinaryValue() : tail(0), tailBits(0) {}
+
+    void clear() {
+        words.clear();
+        tail = 0;
+        tailBits = 0;
+    }
+
+    void push(unsigned digit) {
+        tail = (tail << 1) | (digit & 1);
+        if(++tailBits < 64) return;
+        // Move the top word out; leading zeros are dropped so small values stay in tail
+        uint32_t high = (uint32_t)(tail >> 32);
+        if(!words.empty() || high != 0) words.push_back(high);
+        tail &= 0xFFFFFFFFu;
+        tailBits = 32;
+    }
+
+    bool fitsIn64() const { return words.empty(); }
+    uint64_t low64() const { return tail; }     // The value when fitsIn64()
+
+    string toString() const {
+        if(fitsIn64()) return to_string(tail);
+
+        // Little-endian base 2^32: the words, shifted left by tailBits, plus tail
+        vector<uint32_t> limbs(words.rbegin(), words.rend());
+        int bits = tailBits;
+        if(bits >= 32) {
+            limbs.insert(limbs.begin(), 0);
+            bits -= 32;
+        }
+        if(bits > 0) {
+            uint32_t carry = 0;
+            for(uint32_t& limb : limbs) {
+                uint64_t shifted = ((uint64_t)limb << bits) | carry;
+                limb = (uint32_t)shifted;
+                carry = (uint32_t)(shifted >> 32);
+            }
+            if(carry != 0) limbs.push_back(carry);
+        }
+        uint64_t add = tail;
+        for(size_t i = 0; add != 0; i++) {
+            if(i == limbs.size()) limbs.push_back(0);
+            uint64_t sum = (uint64_t)limbs[i] + (uint32_t)add;
+            limbs[i] = (uint32_t)sum;
+            add = (add >> 32) + (sum >> 32);
+        }
+
+        // Repeated division by 10^9 gives nine decimal digits at a time
+        vector<uint32_t> groups;
+        while(!limbs.empty()) {
+            uint64_t remainder = 0;
+            for(size_t i = limbs.size(); i-- > 0; ) {
+                uint64_t current = (remainder << 32) | limbs[i];
+                limbs[i] = (uint32_t)(current / 1000000000u);
+                remainder = current % 1000000000u;
+            }
+            groups.push_back((uint32_t)remainder);
+            while(!limbs.empty() && limbs.back() == 0) limbs.pop_back();
+        }
+        string text = to_string(groups.back());
+        for(size_t i = groups.size() - 1; i-- > 0; ) {
+            string group = to_string(groups[i]);
+            text.append(9 - group.size(), '0');
+            text += group;
+        }
+        return text;
+    }
+};
+
+#endif // TRANSDUCER_H
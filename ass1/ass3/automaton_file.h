@@ -0,0 +1,271 @@
+#ifndef AUTOMATON_FILE_H
+#define AUTOMATON_FILE_H
+
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Automaton definition files, read by all ass3 programs with -f <file> instead
+// of answering their prompts. The format is line based:
+//
+//   # The n-th symbol from the end is 'a', for n = 2
+//   states 3
+//   symbols 2
+//   start 0                 (optional, default 0)
+//   accept 2                (any number of states, on one or more lines)
+//   0 a 0 1                 (from, symbol, one or more targets)
+//   0 b 0
+//   1 a 2
+//   1 b 2
+//   2 eps 0                 (e-move)
+//
+// States are 0 to states - 1 and symbols the letters from 'a' on; "eps"
+// marks an e-move. "states" and "symbols" come before anything that uses
+// them. '#' starts a comment that runs to the end of the line, and lines may
+// end in "\r\n". Repeated moves are allowed and count once.
+//
+// Each program takes what it can run: q1 has no e-moves, q4 needs a DFA (at
+// most one target per state and symbol, no e-moves), and q2 and q3 name
+// states with single characters (see their -f handling).
+
+const int AUTOMATON_EPSILON = -1;      // Symbol of an e-move
+
+struct AutomatonMove {
+    int from;
+    int symbol;         // 0 for 'a', ..., or AUTOMATON_EPSILON
+    int to;
+};
+
+struct AutomatonDefinition {
+    int states = 0;
+    int symbols = 0;
+    int start = 0;
+    vector<int> accepting;          // In file order, may repeat
+    vector<AutomatonMove> moves;    // In file order, may repeat
+};
+
+// A whole file in memory: mapped where the system allows it, so the parser
+// reads the page cache directly, and read in one piece otherwise
+class MappedFile {
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+    vector<char> copy;          // Used when the file is read instead of mapped
+    bool mapped = false;
+
+public:
+    MappedFile() {}
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (mapped) munmap((void*)bytes, length);
+#endif
+    }
+
+    bool open(const string& path) {
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        bool ok = fstat(fd, &info) == 0;
+        if (ok && info.st_size > 0) {
+            void* address = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address != MAP_FAILED) {
+                madvise(address, (size_t)info.st_size, MADV_SEQUENTIAL);
+                bytes = (const char*)address;
+                length = (size_t)info.st_size;
+                mapped = true;
+            }
+        }
+        close(fd);
+        if (!ok) return false;
+        // Pipes and FIFOs report size 0 too, so only a regular file is empty
+        if (mapped || (S_ISREG(info.st_mode) && info.st_size == 0)) return true;
+#endif
+        // Not mappable (a pipe, or no mmap): read it
+        FILE* fp = fopen(path.c_str(), "rb");
+        if (fp == nullptr) return false;
+        char buffer[1 << 16];
+        size_t got;
+        while ((got = fread(buffer, 1, sizeof(buffer), fp)) > 0) copy.insert(copy.end(), buffer, buffer + got);
+        bool failed = ferror(fp) != 0;
+        fclose(fp);
+        bytes = copy.data();
+        length = copy.size();
+        return !failed;
+    }
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+};
+
+// Parser over the bytes of a definition file. Integers go through
+// from_chars straight from the buffer; nothing is copied.
+class AutomatonFileParser {
+private:
+    const char* p;
+    const char* end;
+    size_t line = 1;
+    string error;
+
+    bool fail(const string& message) {
+        if (error.empty()) error = "line " + to_string(line) + ": " + message;
+        return false;
+    }
+
+    // Skip blanks and comments up to the next token or line break
+    void skipBlanks() {
+        while (p < end) {
+            if (*p == ' ' || *p == '\t' || *p == '\r') {
+                p++;
+            } else if (*p == '#') {
+                while (p < end && *p != '\n') p++;
+            } else {
+                break;
+            }
+        }
+    }
+
+    bool atLineEnd() {
+        skipBlanks();
+        return p == end || *p == '\n';
+    }
+
+    static bool separator(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '#';
+    }
+
+    const char* tokenEnd() const {
+        const char* q = p;
+        while (q < end && !separator(*q)) q++;
+        return q;
+    }
+
+    bool readInt(int& value) {
+        skipBlanks();
+        auto result = from_chars(p, end, value);
+        if (result.ec != errc() || (result.ptr < end && !separator(*result.ptr))) return fail("expected a number");
+        p = result.ptr;
+        return true;
+    }
+
+    bool readState(const AutomatonDefinition& result, int& state) {
+        if (!readInt(state)) return false;
+        if (state < 0 || state >= result.states) return fail("state " + to_string(state) + " out of range");
+        return true;
+    }
+
+    bool keyword(const char* word, size_t size) const {
+        return (size_t)(tokenEnd() - p) == size && memcmp(p, word, size) == 0;
+    }
+
+    bool parseLine(AutomatonDefinition& result, bool& haveStates, bool& haveSymbols) {
+        if (*p >= '0' && *p <= '9') {
+            if (!haveStates || !haveSymbols) return fail("move before \"states\" and \"symbols\"");
+            AutomatonMove move;
+            if (!readState(result, move.from)) return false;
+            skipBlanks();
+            const char* last = tokenEnd();
+            if (last - p == 1 && *p >= 'a' && *p < 'a' + result.symbols) {
+                move.symbol = *p - 'a';
+            } else if (keyword("eps", 3)) {
+                move.symbol = AUTOMATON_EPSILON;
+            } else {
+                return fail("expected a symbol from 'a' to '" + string(1, (char)('a' + result.symbols - 1)) + "' or eps");
+            }
+            p = last;
+            if (atLineEnd()) return fail("move without a target");
+            // The targets are most of the file: parse them in place without
+            // going back through skipBlanks for every number
+            while (true) {
+                auto parsed = from_chars(p, end, move.to);
+                if (parsed.ec != errc() || (parsed.ptr < end && !separator(*parsed.ptr))) return fail("expected a number");
+                if ((unsigned)move.to >= (unsigned)result.states) return fail("state " + to_string(move.to) + " out of range");
+                result.moves.push_back(move);
+                p = parsed.ptr;
+                while (p < end && *p == ' ') p++;
+                if (p == end || *p == '\n') return true;
+                if (separator(*p) && atLineEnd()) return true;
+            }
+        }
+
+        if (keyword("states", 6)) {
+            p = tokenEnd();
+            if (haveStates) return fail("repeated \"states\"");
+            if (!readInt(result.states)) return false;
+            if (result.states < 1) return fail("need at least one state");
+            haveStates = true;
+        } else if (keyword("symbols", 7)) {
+            p = tokenEnd();
+            if (haveSymbols) return fail("repeated \"symbols\"");
+            if (!readInt(result.symbols)) return false;
+            if (result.symbols < 1 || result.symbols > 26) return fail("symbols must be 1 to 26");
+            haveSymbols = true;
+        } else if (keyword("start", 5)) {
+            p = tokenEnd();
+            if (!haveStates) return fail("\"start\" before \"states\"");
+            if (!readState(result, result.start)) return false;
+        } else if (keyword("accept", 6)) {
+            p = tokenEnd();
+            if (!haveStates) return fail("\"accept\" before \"states\"");
+            while (!atLineEnd()) {
+                int state;
+                if (!readState(result, state)) return false;
+                result.accepting.push_back(state);
+            }
+        } else {
+            return fail("unknown line \"" + string(p, tokenEnd()) + "\"");
+        }
+        if (!atLineEnd()) return fail("unexpected \"" + string(p, tokenEnd()) + "\"");
+        return true;
+    }
+
+public:
+    AutomatonFileParser(const char* data, size_t size) : p(data), end(data + size) {}
+
+    bool parse(AutomatonDefinition& result) {
+        result = AutomatonDefinition();
+        result.moves.reserve((end - p) / 8);    // Rough guess; most moves take 8 to 12 bytes
+        bool haveStates = false, haveSymbols = false;
+        while (p < end) {
+            if (!atLineEnd() && !parseLine(result, haveStates, haveSymbols)) return false;
+            if (p < end) {      // At the line break
+                p++;
+                line++;
+            }
+        }
+        if (!haveStates || !haveSymbols) return fail("missing \"states\" or \"symbols\"");
+        return true;
+    }
+
+    const string& getError() const { return error; }
+};
+
+// Load a definition file; on failure error says where and why
+inline bool loadAutomatonFile(const string& path, AutomatonDefinition& result, string& error) {
+    MappedFile file;
+    if (!file.open(path)) {
+        error = "cannot read " + path;
+        return false;
+    }
+    AutomatonFileParser parser(file.data(), file.size());
+    if (!parser.parse(result)) {
+        error = path + ": " + parser.getError();
+        return false;
+    }
+    return true;
+}
+
+#endif // AUTOMATON_FILE_H
@@ -3,6 +3,12 @@
 #include <string>
 #include <set>
 #include <iomanip>
+#include <fstream>
+#include <algorithm>
+#include <cstdint>
+#include "automaton_file.h"
+#include "sparse_nfa.h"
+#include "trim.h"
 
 using namespace std;
 
@@ -10,10 +16,15 @@ class FiniteAutomaton {
 private:
     int numStates;
     int numSymbols;
-    vector<vector<set<int>>> transitions;  // Using set to store multiple transitions
     int startState;
     set<int> acceptStates;
 
+    // Moves are kept in compressed sparse rows, so memory grows with the
+    // number of moves instead of states x symbols. Moves added one at a time
+    // collect in pendingMoves and are merged in when the table is next read.
+    mutable SparseNFA transitions;
+    mutable vector<AutomatonMove> pendingMoves;
+
     bool isValidState(int state) const {
         return state >= 0 && state < numStates;
     }
@@ -22,7 +33,63 @@ public:
     FiniteAutomaton(int states, int symbols) : 
         numStates(states), 
         numSymbols(symbols),
-        transitions(states, vector<set<int>>(symbols)) {}
+        startState(0),
+        transitions(states, symbols, 0, {}, {}) {}
+
+    // Takes the moves, start and accept states of a loaded automaton as they are
+    explicit FiniteAutomaton(const SparseNFA& nfa) :
+        numStates(nfa.getNumStates()),
+        numSymbols(nfa.getNumSymbols()),
+        startState(nfa.getStartState()),
+        transitions(nfa) {
+        for (int s = 0; s < numStates; s++) {
+            if (nfa.isAccepting(s)) acceptStates.insert(s);
+        }
+    }
+
+    // Building without the prompts; out-of-range states are ignored like in inputTransitions
+    void setStartState(int state) { startState = state; }
+    void addAcceptState(int state) {
+        if (isValidState(state)) acceptStates.insert(state);
+    }
+    void addTransition(int from, int symbol, int to) {
+        if (isValidState(from) && isValidState(to) && symbol >= 0 && symbol < numSymbols) {
+            pendingMoves.push_back(AutomatonMove{from, symbol, to});
+        }
+    }
+
+    int getNumStates() const { return numStates; }
+    int getNumSymbols() const { return numSymbols; }
+    int getStartState() const { return startState; }
+    bool isAcceptState(int state) const { return acceptStates.count(state) != 0; }
+    StateRange getTransitions(int from, int symbol) const { return getTable().moves(from, symbol); }
+
+    // All moves; the start and accept states are the ones above, not the table's
+    const SparseNFA& getTable() const {
+        if (!pendingMoves.empty()) {
+            for (int s = 0; s < numStates; s++) {
+                for (uint32_t i = transitions.firstMove(s); i < transitions.lastMove(s); i++) {
+                    pendingMoves.push_back(AutomatonMove{s, transitions.moveSymbol(i), transitions.moveTarget(i)});
+                }
+            }
+            transitions = SparseNFA(numStates, numSymbols, 0, pendingMoves, {});
+            vector<AutomatonMove>().swap(pendingMoves);
+        }
+        return transitions;
+    }
+
+    // The moves together with this automaton's start and accept states
+    SparseNFA toSparseNFA() const {
+        const SparseNFA& table = getTable();
+        vector<AutomatonMove> moves;
+        moves.reserve(table.moveCount());
+        for (int s = 0; s < numStates; s++) {
+            for (uint32_t i = table.firstMove(s); i < table.lastMove(s); i++) {
+                moves.push_back(AutomatonMove{s, table.moveSymbol(i), table.moveTarget(i)});
+            }
+        }
+        return SparseNFA(numStates, numSymbols, startState, moves, vector<int>(acceptStates.begin(), acceptStates.end()));
+    }
 
     void inputTransitions() {
         cout << "\nEnter the start state (0 to " << numStates - 1 << "): ";
@@ -59,7 +126,7 @@ public:
                     int target;
                     cin >> target;
                     if (isValidState(target)) {
-                        transitions[i][j].insert(target);
+                        pendingMoves.push_back(AutomatonMove{i, j, target});
                     }
                 }
             }
@@ -84,12 +151,12 @@ public:
             cout << i << (i == startState ? "(S)" : "") << "\t";
             
             for (int j = 0; j < numSymbols; j++) {
-                if (transitions[i][j].empty()) {
+                if (getTransitions(i, j).empty()) {
                     cout << "-\t";
                 } else {
                     cout << "{";
                     bool first = true;
-                    for (int state : transitions[i][j]) {
+                    for (int state : getTransitions(i, j)) {
                         if (!first) cout << ",";
                         cout << state;
                         first = false;
@@ -106,7 +173,7 @@ public:
         // Check if each state has exactly one transition for each symbol
         for (int i = 0; i < numStates; i++) {
             for (int j = 0; j < numSymbols; j++) {
-                if (transitions[i][j].size() != 1) {
+                if (getTransitions(i, j).size() != 1) {
                     return false;
                 }
             }
@@ -125,10 +192,10 @@ public:
             cout << "This is a Non-deterministic Finite Automaton (NFA) because:\n";
             for (int i = 0; i < numStates; i++) {
                 for (int j = 0; j < numSymbols; j++) {
-                    if (transitions[i][j].size() != 1) {
+                    if (getTransitions(i, j).size() != 1) {
                         cout << "- State " << i << " with symbol '" 
                              << static_cast<char>('a' + j) << "' has "
-                             << (transitions[i][j].empty() ? "no" : 
+                             << (getTransitions(i, j).empty() ? "no" : 
                                  "multiple") << " transitions\n";
                     }
                 }
@@ -137,20 +204,372 @@ public:
     }
 };
 
-int main() {
+// Largest byte-table set BitParallelNFA builds; past it steps go state by state
+const size_t NFA_BYTE_TABLE_LIMIT = 1 << 24;
+
+// Largest set of successor masks (states x symbols x states bits); past it
+// steps follow the moves of the sparse table instead
+const size_t NFA_SUCCESSOR_LIMIT = 1 << 26;
+
+// Runs a FiniteAutomaton (DFA or NFA) on strings over 'a', 'b', ... with the
+// set of active states kept as a bitset of 64-bit words. Each state has a
+// precomputed successor mask per symbol, and a step ORs together the masks
+// of the active states, word by word.
+// The masks are also combined into byte tables: for each symbol and each
+// byte of the state set, the OR of the successors of every combination of
+// the 8 states in that byte. A step is then one table row per non-zero byte
+// of the active set, about states / 8 * states / 64 word operations however
+// many states are active, and for up to 64 states just 8 loads and ORs.
+// Automata too large for one mask per state and symbol (they take
+// states^2 / 8 bytes per symbol) step through the moves of the sparse table,
+// so memory stays linear in the moves.
+// Nothing is allocated per symbol.
+class BitParallelNFA {
+private:
+    int numStates;
+    int numSymbols;
+    int words;                      // 64-bit words per state set
+    int bytes;                      // Bytes per state set, (numStates + 7) / 8
+    vector<uint64_t> successors;    // [(symbol * numStates + state) * words + w], may be empty
+    SparseNFA moves;                // Only used when successors is empty
+    vector<uint64_t> byteTables;    // [((symbol * bytes + byte) * 256 + bits) * words + w], may be empty
+    vector<uint64_t> startSet;
+    vector<uint64_t> acceptSet;
+
+    int symbolOf(char c) const {
+        int symbol = c - 'a';
+        return (symbol >= 0 && symbol < numSymbols) ? symbol : -1;
+    }
+
+    void buildByteTables() {
+        byteTables.assign((size_t)numSymbols * bytes * 256 * words, 0);
+        for (int c = 0; c < numSymbols; c++) {
+            for (int byte = 0; byte < bytes; byte++) {
+                uint64_t* table = byteTables.data() + ((size_t)c * bytes + byte) * 256 * words;
+                // Each entry is an earlier entry plus the successors of one more state
+                for (int bits = 1; bits < 256; bits++) {
+                    int state = 8 * byte + __builtin_ctz(bits);
+                    const uint64_t* earlier = table + (size_t)(bits & (bits - 1)) * words;
+                    uint64_t* entry = table + (size_t)bits * words;
+                    for (int w = 0; w < words; w++) {
+                        uint64_t mask = (state < numStates) ? successors[((size_t)c * numStates + state) * words + w] : 0;
+                        entry[w] = earlier[w] | mask;
+                    }
+                }
+            }
+        }
+    }
+
+    bool acceptsSmall(const string& input) const {
+        uint64_t active = startSet[0];
+        for (size_t i = 0; i < input.size() && active != 0; i++) {
+            int symbol = symbolOf(input[i]);
+            if (symbol < 0) return false;
+            const uint64_t* tables = byteTables.data() + (size_t)symbol * bytes * 256;
+            uint64_t next = 0;
+            for (int byte = 0; byte < bytes; byte++) {
+                next |= tables[byte * 256 + ((active >> (8 * byte)) & 0xFF)];
+            }
+            active = next;
+        }
+        return (active & acceptSet[0]) != 0;
+    }
+
+    // Step by following the moves of each active state
+    void stepSparse(int symbol, const vector<uint64_t>& active, vector<uint64_t>& next) const {
+        for (int w = 0; w < words; w++) {
+            for (uint64_t bits = active[w]; bits != 0; bits &= bits - 1) {
+                for (int target : moves.moves(64 * w + __builtin_ctzll(bits), symbol)) {
+                    next[target / 64] |= 1ULL << (target % 64);
+                }
+            }
+        }
+    }
+
+    // One step over the byte tables, or state by state without them; false
+    // if no state is active afterwards
+    bool step(int symbol, const vector<uint64_t>& active, vector<uint64_t>& next) const {
+        fill(next.begin(), next.end(), 0);
+        if (!byteTables.empty()) {
+            const uint64_t* tables = byteTables.data() + (size_t)symbol * bytes * 256 * words;
+            for (int byte = 0; byte < bytes; byte++) {
+                unsigned bits = (active[byte / 8] >> (8 * (byte % 8))) & 0xFF;
+                if (bits == 0) continue;
+                const uint64_t* row = tables + ((size_t)byte * 256 + bits) * words;
+                for (int w = 0; w < words; w++) next[w] |= row[w];
+            }
+        } else if (successors.empty()) {
+            stepSparse(symbol, active, next);
+        } else {
+            const uint64_t* masks = successors.data() + (size_t)symbol * numStates * words;
+            for (int w = 0; w < words; w++) {
+                for (uint64_t bits = active[w]; bits != 0; bits &= bits - 1) {
+                    const uint64_t* mask = masks + (size_t)(64 * w + __builtin_ctzll(bits)) * words;
+                    for (int k = 0; k < words; k++) next[k] |= mask[k];
+                }
+            }
+        }
+        uint64_t any = 0;
+        for (int w = 0; w < words; w++) any |= next[w];
+        return any != 0;
+    }
+
+public:
+    explicit BitParallelNFA(const FiniteAutomaton& fa) :
+        numStates(fa.getNumStates()),
+        numSymbols(fa.getNumSymbols()),
+        words(max(1, (fa.getNumStates() + 63) / 64)),
+        bytes(max(1, (fa.getNumStates() + 7) / 8)),
+        startSet(words, 0),
+        acceptSet(words, 0) {
+        if ((size_t)numSymbols * numStates * words * sizeof(uint64_t) > NFA_SUCCESSOR_LIMIT) {
+            moves = fa.getTable();
+        } else {
+            successors.assign((size_t)numSymbols * numStates * words, 0);
+            for (int s = 0; s < numStates; s++) {
+                for (int c = 0; c < numSymbols; c++) {
+                    uint64_t* mask = successors.data() + ((size_t)c * numStates + s) * words;
+                    for (int target : fa.getTransitions(s, c)) mask[target / 64] |= 1ULL << (target % 64);
+                }
+            }
+        }
+        for (int s = 0; s < numStates; s++) {
+            if (fa.isAcceptState(s)) acceptSet[s / 64] |= 1ULL << (s % 64);
+        }
+        int start = fa.getStartState();
+        if (start >= 0 && start < numStates) startSet[start / 64] |= 1ULL << (start % 64);
+
+        if (!successors.empty() && (size_t)numSymbols * bytes * 256 * words * sizeof(uint64_t) <= NFA_BYTE_TABLE_LIMIT) {
+            buildByteTables();
+        }
+    }
+
+    // True if some run on input ends in an accept state; false for symbols
+    // outside the alphabet
+    bool accepts(const string& input) const {
+        if (words == 1 && !byteTables.empty()) return acceptsSmall(input);
+
+        vector<uint64_t> active = startSet, next(words);
+        for (size_t i = 0; i < input.size(); i++) {
+            int symbol = symbolOf(input[i]);
+            if (symbol < 0) return false;
+            if (!step(symbol, active, next)) return false;
+            active.swap(next);
+        }
+        for (int w = 0; w < words; w++) {
+            if (active[w] & acceptSet[w]) return true;
+        }
+        return false;
+    }
+};
+
+// Shift-And engine for automata whose state numbers follow a single chain
+// from the start state 0: every move goes from state i to i + 1 or back to i.
+// Position (Glushkov) automata of patterns like "ab.[bc]+a" have this shape.
+// Bit i of the state word is state i, and with per-byte masks
+//   advance[c]: bit i + 1 set if i -> i + 1 on c
+//   stay[c]:    bit i set if i -> i on c
+// a step is D = ((D << 1) & advance[c]) | (D & stay[c]), a handful of register
+// operations and no determinizing. Word is uint64_t (up to 64 states) or
+// unsigned __int128 (up to 128).
+template <typename Word>
+class ShiftAndNFA {
+private:
+    Word advance[256];
+    Word stay[256];
+    Word acceptMask;
+    bool hasLoops;                  // Some stay mask is non-zero
+
+public:
+    static const int MAX_STATES = 8 * sizeof(Word);
+
+    // True if the automaton has the chain shape and fits in a Word
+    static bool fits(const FiniteAutomaton& fa) {
+        if (fa.getNumStates() > MAX_STATES || fa.getStartState() != 0) return false;
+        for (int s = 0; s < fa.getNumStates(); s++) {
+            for (int c = 0; c < fa.getNumSymbols(); c++) {
+                for (int target : fa.getTransitions(s, c)) {
+                    if (target != s && target != s + 1) return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Requires fits(fa)
+    explicit ShiftAndNFA(const FiniteAutomaton& fa) : acceptMask(0), hasLoops(false) {
+        for (int b = 0; b < 256; b++) advance[b] = stay[b] = 0;
+        for (int s = 0; s < fa.getNumStates(); s++) {
+            for (int c = 0; c < fa.getNumSymbols() && 'a' + c < 256; c++) {
+                for (int target : fa.getTransitions(s, c)) {
+                    if (target == s) stay['a' + c] |= (Word)1 << s;
+                    else advance['a' + c] |= (Word)1 << target;
+                }
+            }
+            if (fa.isAcceptState(s)) acceptMask |= (Word)1 << s;
+        }
+        for (int b = 0; b < 256; b++) hasLoops = hasLoops || stay[b] != 0;
+    }
+
+    // Bytes outside the alphabet have empty masks, so they end every run
+    bool accepts(const string& input) const {
+        const unsigned char* p = (const unsigned char*)input.data();
+        size_t n = input.size();
+        Word state = 1;
+        if (hasLoops) {
+            for (size_t i = 0; i < n; i++) state = ((state << 1) & advance[p[i]]) | (state & stay[p[i]]);
+        } else {
+            // Without loops a run lasts at most MAX_STATES symbols
+            if (n >= (size_t)MAX_STATES) return false;
+            for (size_t i = 0; i < n; i++) state = (state << 1) & advance[p[i]];
+        }
+        return (state & acceptMask) != 0;
+    }
+};
+
+// Position automaton of a pattern over 'a', 'b', ...: letters, '.' for any
+// symbol and [...] for a set of symbols, each optionally followed by '+' (one
+// or more). Item i moves state i to i + 1, so the result always fits
+// ShiftAndNFA when short enough. With search, state 0 also loops on every
+// symbol, so the automaton accepts strings that end with a match. Returns
+// false for a malformed pattern.
+bool patternAutomaton(const string& pattern, int numSymbols, bool search, FiniteAutomaton& result) {
+    vector<vector<int>> items;      // Symbols of each item
+    vector<bool> repeated;
+    for (size_t i = 0; i < pattern.size(); i++) {
+        vector<int> symbols;
+        char c = pattern[i];
+        if (c == '.') {
+            for (int k = 0; k < numSymbols; k++) symbols.push_back(k);
+        } else if (c == '[') {
+            size_t close = pattern.find(']', i);
+            if (close == string::npos) return false;
+            for (size_t j = i + 1; j < close; j++) symbols.push_back(pattern[j] - 'a');
+            i = close;
+        } else if (c == '+' && !items.empty() && !repeated.back()) {
+            repeated.back() = true;
+            continue;
+        } else {
+            symbols.push_back(c - 'a');
+        }
+        for (int symbol : symbols) {
+            if (symbol < 0 || symbol >= numSymbols) return false;
+        }
+        items.push_back(symbols);
+        repeated.push_back(false);
+    }
+
+    FiniteAutomaton fa((int)items.size() + 1, numSymbols);
+    fa.setStartState(0);
+    fa.addAcceptState((int)items.size());
+    if (search) {
+        for (int k = 0; k < numSymbols; k++) fa.addTransition(0, k, 0);
+    }
+    for (size_t i = 0; i < items.size(); i++) {
+        for (int symbol : items[i]) {
+            fa.addTransition((int)i, symbol, (int)i + 1);
+            if (repeated[i]) fa.addTransition((int)i + 1, symbol, (int)i + 1);
+        }
+    }
+    result = fa;
+    return true;
+}
+
+// Automaton of a definition file (see automaton_file.h); false with a message
+// if the file cannot be read or has e-moves
+bool loadFiniteAutomaton(const string& path, FiniteAutomaton& fa) {
+    SparseNFA nfa;
+    string error;
+    if (!loadSparseNFA(path, nfa, error)) {
+        cerr << "ERROR: " << error << "\n";
+        return false;
+    }
+    if (nfa.hasEpsilon()) {
+        cerr << "ERROR: " << path << ": e-moves are not supported\n";
+        return false;
+    }
+    fa = FiniteAutomaton(nfa);
+    return true;
+}
+
+// Print ACCEPTED or REJECTED for each line of the file
+template <typename Runner>
+void classifyLines(istream& file, const Runner& runner) {
+    string word;
+    while (getline(file, word)) {
+        if (!word.empty() && word.back() == '\r') word.pop_back();
+        cout << (runner.accepts(word) ? "ACCEPTED\n" : "REJECTED\n");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // Options: -b <file> reads the automaton as usual, then prints ACCEPTED or
+    //                   REJECTED for each line of the file (with the Shift-And
+    //                   engine when the automaton has its shape)
+    //          -p <pattern> builds the automaton from a pattern (see
+    //                   patternAutomaton) over 'a' up to its highest letter
+    //                   instead of reading it
+    //          -f <file> reads the automaton from a definition file (see
+    //                   automaton_file.h) instead of the prompts
+    string batchPath, pattern, definitionPath;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (string(argv[i]) == "-b") batchPath = argv[i + 1];
+        else if (string(argv[i]) == "-p") pattern = argv[i + 1];
+        else if (string(argv[i]) == "-f") definitionPath = argv[i + 1];
+    }
+
     cout << "Finite Automaton Analyzer\n";
     cout << string(50, '=') << endl;
 
-    int numStates, numSymbols;
-    
-    cout << "Enter number of states: ";
-    cin >> numStates;
-    
-    cout << "Enter number of input symbols: ";
-    cin >> numSymbols;
+    FiniteAutomaton fa(0, 0);
+    if (!pattern.empty()) {
+        int numSymbols = 1;
+        for (char c : pattern) {
+            if (c >= 'a' && c <= 'z') numSymbols = max(numSymbols, c - 'a' + 1);
+        }
+        if (!patternAutomaton(pattern, numSymbols, false, fa)) {
+            cerr << "ERROR: Invalid pattern " << pattern << "\n";
+            return 1;
+        }
+    } else if (!definitionPath.empty()) {
+        if (!loadFiniteAutomaton(definitionPath, fa)) return 1;
+    } else {
+        int numStates, numSymbols;
+        
+        cout << "Enter number of states: ";
+        cin >> numStates;
+        
+        cout << "Enter number of input symbols: ";
+        cin >> numSymbols;
+        if (numSymbols > SPARSE_NFA_MAX_SYMBOLS) {
+            cerr << "ERROR: at most " << SPARSE_NFA_MAX_SYMBOLS << " input symbols\n";
+            return 1;
+        }
+
+        fa = FiniteAutomaton(numStates, numSymbols);
+        fa.inputTransitions();
+    }
+
+    if (!batchPath.empty()) {
+        ifstream file(batchPath);
+        if (!file) {
+            cerr << "ERROR: Cannot open " << batchPath << "\n";
+            return 1;
+        }
+        cout << "\n";
+        // Only the useful states matter for membership; trimming can also
+        // bring an automaton down to a size Shift-And or the byte tables take
+        FiniteAutomaton trimmed(trimNFA(fa.toSparseNFA()).nfa);
+        if (ShiftAndNFA<uint64_t>::fits(trimmed)) {
+            classifyLines(file, ShiftAndNFA<uint64_t>(trimmed));
+        } else if (ShiftAndNFA<unsigned __int128>::fits(trimmed)) {
+            classifyLines(file, ShiftAndNFA<unsigned __int128>(trimmed));
+        } else {
+            classifyLines(file, BitParallelNFA(trimmed));
+        }
+        return 0;
+    }
 
-    FiniteAutomaton fa(numStates, numSymbols);
-    fa.inputTransitions();
     fa.displayTransitionTable();
     fa.analyzeAutomaton();
 
@@ -4,6 +4,7 @@
 #include <queue>
 #include <algorithm>
 #include <set>
+#include "trim.h"
 
 using namespace std;
 
@@ -32,17 +33,17 @@ string getTransition(int numStates) {
     }
 }
 
-// Get next DFA state for given NFA states and input symbol
+// Get next DFA state for given NFA states and input symbol. The NFA is the
+// digit-string table or a SparseNFA (see forEachTarget).
+template <typename Table>
 string getNextState(const string& currentStates, int symbol, 
-                   const vector<vector<string>>& nfa) {
+                   const Table& nfa) {
     set<char> nextStates;
     for(char state : currentStates) {
         int stateNum = state - '0';
-        if(nfa[stateNum][symbol] != "-") {
-            for(char c : nfa[stateNum][symbol]) {
-                nextStates.insert(c);
-            }
-        }
+        forEachTarget(nfa, stateNum, symbol, [&](int target) {
+            nextStates.insert((char)('0' + target));
+        });
     }
     
     if(nextStates.empty()) return "-";
@@ -54,56 +55,14 @@ string getNextState(const string& currentStates, int symbol,
     return result;
 }
 
-int main() {
-    // Get NFA details
-    int numStates, numSymbols;
-    cout << "Enter number of states: ";
-    cin >> numStates;
-    cout << "Enter number of input symbols: ";
-    cin >> numSymbols;
-    
-    // Initialize NFA table
-    vector<vector<string>> nfa(numStates, vector<string>(numSymbols));
-    
-    // Get NFA transitions
-    cout << "\nEnter NFA Transition Table:\n";
-    cout << "Use '-' for no transition and string of states (e.g., '012') for transitions\n\n";
-    
-    // Print header
-    cout << "State\t";
-    for(int i = 0; i < numSymbols; i++) 
-        cout << (char)('a' + i) << "\t";
-    cout << "\n";
-    printLine(40);
-    
-    // Get transitions
-    for(int i = 0; i < numStates; i++) {
-        cout << i << "\t";
-        for(int j = 0; j < numSymbols; j++) {
-            nfa[i][j] = getTransition(numStates);
-        }
-    }
-    
-    // Print NFA table
-    cout << "\nNFA Transition Table:\n";
-    cout << "State\t";
-    for(int i = 0; i < numSymbols; i++) 
-        cout << (char)('a' + i) << "\t";
-    cout << "\n";
-    printLine(40);
-    
-    for(int i = 0; i < numStates; i++) {
-        cout << i << "\t";
-        for(int j = 0; j < numSymbols; j++) {
-            cout << nfa[i][j] << "\t";
-        }
-        cout << "\n";
-    }
-    
-    // Convert NFA to DFA
-    vector<string> dfaStates;
-    vector<vector<string>> dfa;
+// Subset construction from NFA state 0. dfaStates[i] names the i-th DFA state
+// (its NFA states as digits) and dfa[i] holds its transitions, "-" for none.
+template <typename Table>
+void convertToDFA(const Table& nfa, int numSymbols,
+                  vector<string>& dfaStates, vector<vector<string>>& dfa) {
     queue<string> unprocessedStates;
+    dfaStates.clear();
+    dfa.clear();
     
     // Start with initial state
     dfaStates.push_back("0");
@@ -131,6 +90,60 @@ int main() {
         
         dfa.push_back(transitions);
     }
+}
+
+// States are named by single characters '0' + state, up to the last
+// character before the signed char range runs out
+const int MAX_NAMED_STATES = 128 - '0';
+
+// Trimmed NFA of a definition file (see automaton_file.h). Trimming makes
+// the start state 0, where the subset construction begins; the file must have
+// no e-moves, and what is left must fit the state names.
+bool loadNFA(const string& path, TrimmedNFA& trimmed) {
+    SparseNFA nfa;
+    string error;
+    if(!loadSparseNFA(path, nfa, error)) {
+        cerr << "ERROR: " << error << "\n";
+        return false;
+    }
+    if(nfa.hasEpsilon()) {
+        error = "e-moves are not supported";
+    } else {
+        trimmed = trimNFA(nfa);
+        if(trimmed.nfa.getNumStates() > MAX_NAMED_STATES) {
+            error = "at most " + to_string(MAX_NAMED_STATES) + " useful states";
+        }
+    }
+    if(!error.empty()) {
+        cerr << "ERROR: " << path << ": " << error << "\n";
+        return false;
+    }
+    return true;
+}
+
+// Print the NFA, convert it and print the DFA
+template <typename Table>
+void showConversion(const Table& nfa, int numStates, int numSymbols) {
+    // Print NFA table
+    cout << "\nNFA Transition Table:\n";
+    cout << "State\t";
+    for(int i = 0; i < numSymbols; i++) 
+        cout << (char)('a' + i) << "\t";
+    cout << "\n";
+    printLine(40);
+    
+    for(int i = 0; i < numStates; i++) {
+        cout << i << "\t";
+        for(int j = 0; j < numSymbols; j++) {
+            cout << digitCell(nfa, i, j) << "\t";
+        }
+        cout << "\n";
+    }
+    
+    // Convert NFA to DFA
+    vector<string> dfaStates;
+    vector<vector<string>> dfa;
+    convertToDFA(nfa, numSymbols, dfaStates, dfa);
     
     // Print DFA table
     cout << "\nResulting DFA Transition Table:\n";
@@ -147,6 +160,65 @@ int main() {
         }
         cout << "\n";
     }
+}
+
+int main(int argc, char* argv[]) {
+    // Option: -f <file> reads the NFA from a definition file instead of the prompts
+    string definitionPath;
+    for(int i = 1; i + 1 < argc; i += 2) {
+        if(string(argv[i]) == "-f") definitionPath = argv[i + 1];
+    }
+
+    if(!definitionPath.empty()) {
+        TrimmedNFA trimmed;
+        if(!loadNFA(definitionPath, trimmed)) return 1;
+        if(trimmed.changed()) cout << "\n" << trimmed.describe() << "\n";
+        showConversion(trimmed.nfa, trimmed.nfa.getNumStates(), trimmed.nfa.getNumSymbols());
+        return 0;
+    }
+
+    // Get NFA details
+    int numStates, numSymbols;
+    cout << "Enter number of states: ";
+    cin >> numStates;
+    cout << "Enter number of input symbols: ";
+    cin >> numSymbols;
+    if(numSymbols > SPARSE_NFA_MAX_SYMBOLS) {
+        cerr << "ERROR: at most " << SPARSE_NFA_MAX_SYMBOLS << " input symbols\n";
+        return 1;
+    }
+    
+    // Initialize NFA table
+    vector<vector<string>> nfa(numStates, vector<string>(numSymbols));
+    
+    // Get NFA transitions
+    cout << "\nEnter NFA Transition Table:\n";
+    cout << "Use '-' for no transition and string of states (e.g., '012') for transitions\n\n";
+    
+    // Print header
+    cout << "State\t";
+    for(int i = 0; i < numSymbols; i++) 
+        cout << (char)('a' + i) << "\t";
+    cout << "\n";
+    printLine(40);
+    
+    // Get transitions
+    for(int i = 0; i < numStates; i++) {
+        cout << i << "\t";
+        for(int j = 0; j < numSymbols; j++) {
+            nfa[i][j] = getTransition(numStates);
+        }
+    }
     
+    // Trim first. Without accept states every state counts as accepting, so
+    // this drops the states the start cannot reach; if there are none, the
+    // table is converted as entered.
+    TrimmedNFA trimmed = trimNFA(digitTableNFA(nfa, numSymbols));
+    if(trimmed.changed()) {
+        cout << "\n" << trimmed.describe() << "\n";
+        showConversion(trimmed.nfa, trimmed.nfa.getNumStates(), numSymbols);
+    } else {
+        showConversion(nfa, numStates, numSymbols);
+    }
     return 0;
-}
\ No newline at end of file
+}
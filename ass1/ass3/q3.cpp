@@ -3,7 +3,8 @@
 #include <string>
 #include <cstring>
 #include <algorithm>
-#define MAX_LEN 100
+#include "trim.h"
+#define MAX_LEN 100  // Initial DFA table size; grows when a conversion needs more
 
 using namespace std;
 
@@ -58,34 +59,41 @@ int indexing(vector<DFA>& dfa) {
     return -1;
 }
 
-// Display epsilon closure
-void Display_closure(int states, vector<int>& closure_ar,
-                    vector<string>& closure_table,
-                    vector<vector<string>>& NFA_TABLE,
-                    vector<vector<string>>& DFA_TABLE) {
+// Count the targets of state in column of either table form (see forEachTarget)
+template <typename Table>
+void check_targets(vector<int>& ar, const Table& table, int state, int column) {
+    forEachTarget(table, state, column, [&](int target) { ar[target]++; });
+}
+
+// Compute the e-closure of every state into closure_table. The NFA is the
+// string table or a SparseNFA; e-moves are column `symbols`.
+template <typename Table>
+void compute_closures(int states, vector<int>& closure_ar,
+                      vector<string>& closure_table,
+                      const Table& NFA_TABLE) {
     for(int i = 0; i < states; i++) {
         reset(closure_ar);
         closure_ar[i] = 2;
 
-        if(NFA_TABLE[i][symbols] != "-") {
-            buffer = NFA_TABLE[i][symbols];
-            check(closure_ar, buffer);
-            int z = closure(closure_ar);
+        check_targets(closure_ar, NFA_TABLE, i, symbols);
+        int z = closure(closure_ar);
 
-            while(z != 100) {
-                if(NFA_TABLE[z][symbols] != "-") {
-                    buffer = NFA_TABLE[z][symbols];
-                    check(closure_ar, buffer);
-                }
-                closure_ar[z]++;
-                z = closure(closure_ar);
-            }
+        while(z != 100) {
+            check_targets(closure_ar, NFA_TABLE, z, symbols);
+            closure_ar[z]++;
+            z = closure(closure_ar);
         }
 
-        cout << "\n e-Closure (" << i << ") :\t";  // Changed from 'A'+i to i
         buffer.clear();
         state(closure_ar, buffer);
         closure_table[i] = buffer;
+    }
+}
+
+// Display epsilon closure
+void Display_closure(int states, vector<string>& closure_table) {
+    for(int i = 0; i < states; i++) {
+        cout << "\n e-Closure (" << i << ") :\t";  // Changed from 'A'+i to i
         cout << closure_table[i] << endl;
     }
 }
@@ -96,6 +104,7 @@ int new_states(vector<DFA>& dfa, const string& S) {
         if(dfa[i].states == S) return 0;
     }
 
+    if(last_index == (int)dfa.size()) dfa.push_back(DFA());
     dfa[last_index].states = S;
     dfa[last_index].count = 0;
     last_index++;
@@ -103,22 +112,17 @@ int new_states(vector<DFA>& dfa, const string& S) {
 }
 
 // Transition function from NFA to DFA
+template <typename Table>
 void trans(const string& S, int M, vector<string>& clsr_t, int st,
-           vector<vector<string>>& NFT, string& TB) {
+           const Table& NFT, string& TB) {
     vector<int> arr(st, 0);
-    string temp, temp2;
+    string temp;
 
     for(char c : S) {
         int j = c - '0';  // Changed from 'A' to '0'
-        temp = NFT[j][M];
-
-        if(temp != "-") {
-            for(char g : temp) {
-                int k = g - '0';  // Changed from 'A' to '0'
-                temp2 = clsr_t[k];
-                check(arr, temp2);
-            }
-        }
+        forEachTarget(NFT, j, M, [&](int k) {
+            check(arr, clsr_t[k]);
+        });
     }
 
     state(arr, temp);
@@ -156,6 +160,49 @@ void Display_DFA(int last_index, vector<DFA>& dfa_states,
     }
 }
 
+// Convert to a DFA from the e-closure of state 0. dfa_states[0] is the empty
+// state "-" and row i of DFA_TABLE belongs to dfa_states[i + 1]; both tables
+// are refilled, and last_index and zz are set for Display_DFA.
+template <typename Table>
+void convert_to_dfa(int states, vector<string>& closure_table,
+                    const Table& NFA_TABLE,
+                    vector<DFA>& dfa_states,
+                    vector<vector<string>>& DFA_TABLE) {
+    dfa_states.assign(MAX_LEN, DFA());
+    DFA_TABLE.assign(MAX_LEN, vector<string>(symbols));
+    last_index = 0;
+    zz = 0;
+
+    dfa_states[last_index].states = "-";
+    dfa_states[last_index].count = 1;
+    last_index++;
+
+    buffer = closure_table[0];
+    dfa_states[last_index].states = buffer;
+    last_index++;
+
+    int Sm = 1, ind = 1;
+    int start_index = 1;
+    string T_buf;
+
+    while(ind != -1) {
+        dfa_states[start_index].count = 1;
+        Sm = 0;
+        
+        if(zz == (int)DFA_TABLE.size()) DFA_TABLE.push_back(vector<string>(symbols));
+        for(int i = 0; i < symbols; i++) {
+            trans(buffer, i, closure_table, states, NFA_TABLE, T_buf);
+            DFA_TABLE[zz][i] = T_buf;
+            Sm += new_states(dfa_states, T_buf);
+        }
+        
+        ind = indexing(dfa_states);
+        if(ind != -1)
+            buffer = dfa_states[++start_index].states;
+        zz++;
+    }
+}
+
 // Function to get valid state input
 string getStateInput(int states) {
     string input;
@@ -178,17 +225,88 @@ string getStateInput(int states) {
     return input;
 }
 
-int main() {
+// Trimmed e-NFA of a definition file (see automaton_file.h). Closures are
+// written as decimal state numbers and read back digit by digit, so at most
+// 10 states may be left; trimming makes the start state 0, where the
+// conversion begins.
+bool load_nfa(const string& path, TrimmedNFA& trimmed) {
+    SparseNFA nfa;
+    string error;
+    if(!loadSparseNFA(path, nfa, error)) {
+        cerr << "ERROR: " << error << "\n";
+        return false;
+    }
+    trimmed = trimNFA(nfa);
+    if(trimmed.nfa.getNumStates() > 10) error = "at most 10 useful states";
+    if(!error.empty()) {
+        cerr << "ERROR: " << path << ": " << error << "\n";
+        return false;
+    }
+    return true;
+}
+
+// Print the e-NFA and its closures, convert it and print the DFA
+template <typename Table>
+void show_conversion(int states, const Table& NFA_TABLE) {
+    vector<vector<string>> DFA_TABLE(MAX_LEN, vector<string>(symbols));
+
+    cout << "\n NFA STATE TRANSITION TABLE \n\n";
+    cout << "STATES\t";
+
+    for(int i = 0; i < symbols; i++)
+        cout << "|" << (char)('a' + i) << "\t";  // Changed from i to 'a'+i
+    cout << "eps\n";
+
+    cout << "--------+------------------------------------\n";
+    for(int i = 0; i < states; i++) {
+        cout << i << "\t";  // Changed from 'A'+i to i
+        for(int j = 0; j <= symbols; j++) {
+            cout << "|" << digitCell(NFA_TABLE, i, j) << " \t";
+        }
+        cout << "\n";
+    }
+
+    vector<int> closure_ar(states);
+    vector<string> closure_table(states);
+    vector<DFA> dfa_states(MAX_LEN);
+
+    compute_closures(states, closure_ar, closure_table, NFA_TABLE);
+    Display_closure(states, closure_table);
+
+    convert_to_dfa(states, closure_table, NFA_TABLE, dfa_states, DFA_TABLE);
+
+    Display_DFA(last_index, dfa_states, DFA_TABLE);
+}
+
+int main(int argc, char* argv[]) {
+    // Option: -f <file> reads the e-NFA from a definition file instead of the prompts
+    string definition_path;
+    for(int i = 1; i + 1 < argc; i += 2) {
+        if(string(argv[i]) == "-f") definition_path = argv[i + 1];
+    }
+
+    if(!definition_path.empty()) {
+        TrimmedNFA trimmed;
+        if(!load_nfa(definition_path, trimmed)) return 1;
+        if(trimmed.changed()) cout << "\n" << trimmed.describe() << "\n";
+        symbols = trimmed.nfa.getNumSymbols();
+        show_conversion(trimmed.nfa.getNumStates(), trimmed.nfa);
+        return 0;
+    }
+
     int states;
     cout << "Enter number of states: ";
     cin >> states;
 
     cout << "Enter number of input symbols: ";
     cin >> symbols;
+    if(symbols > SPARSE_NFA_MAX_SYMBOLS) {
+        cerr << "ERROR: at most " << SPARSE_NFA_MAX_SYMBOLS << " input symbols\n";
+        return 1;
+    }
 
     // Initialize NFA table
     vector<vector<string>> NFA_TABLE(states, vector<string>(symbols + 1));
-    vector<vector<string>> DFA_TABLE(MAX_LEN, vector<string>(symbols));
 
     cout << "\nEnter the transition table:" << endl;
     cout << "Use '-' for no transition and numbers for states (e.g., '012' for multiple states)" << endl;
@@ -210,57 +328,16 @@ int main() {
         }
     }
 
-    cout << "\n NFA STATE TRANSITION TABLE \n\n";
-    cout << "STATES\t";
-
-    for(int i = 0; i < symbols; i++)
-        cout << "|" << (char)('a' + i) << "\t";  // Changed from i to 'a'+i
-    cout << "eps\n";
-
-    cout << "--------+------------------------------------\n";
-    for(int i = 0; i < states; i++) {
-        cout << i << "\t";  // Changed from 'A'+i to i
-        for(int j = 0; j <= symbols; j++) {
-            cout << "|" << NFA_TABLE[i][j] << " \t";
-        }
-        cout << "\n";
-    }
-
-    vector<int> closure_ar(states);
-    vector<string> closure_table(states);
-    vector<DFA> dfa_states(MAX_LEN);
-
-    Display_closure(states, closure_ar, closure_table, NFA_TABLE, DFA_TABLE);
-
-    dfa_states[last_index].states = "-";
-    dfa_states[last_index].count = 1;
-    last_index++;
-
-    buffer = closure_table[0];
-    dfa_states[last_index].states = buffer;
-    last_index++;
-
-    int Sm = 1, ind = 1;
-    int start_index = 1;
-    string T_buf;
-
-    while(ind != -1) {
-        dfa_states[start_index].count = 1;
-        Sm = 0;
-        
-        for(int i = 0; i < symbols; i++) {
-            trans(buffer, i, closure_table, states, NFA_TABLE, T_buf);
-            DFA_TABLE[zz][i] = T_buf;
-            Sm += new_states(dfa_states, T_buf);
-        }
-        
-        ind = indexing(dfa_states);
-        if(ind != -1)
-            buffer = dfa_states[++start_index].states;
-        zz++;
+    // Trim first. The table has no accept states, so all states count as
+    // accepting and only those the start cannot reach go; if none do, the
+    // table is converted as entered.
+    TrimmedNFA trimmed = trimNFA(digitTableNFA(NFA_TABLE, symbols));
+    if(trimmed.changed()) {
+        cout << "\n" << trimmed.describe() << "\n";
+        show_conversion(trimmed.nfa.getNumStates(), trimmed.nfa);
+    } else {
+        show_conversion(states, NFA_TABLE);
     }
 
-    Display_DFA(last_index, dfa_states, DFA_TABLE);
-
     return 0;
-}
\ No newline at end of file
+}
@@ -3,7 +3,7 @@
 #include <string>
 #include <set>
 #include <map>
-#include <queue>
+#include "trim.h"
 using namespace std;
 
 // Structure to represent a DFA
@@ -15,28 +15,50 @@ struct DFA {
     int initialState;
 };
 
-// Function to get reachable states from initial state
-set<int> getReachableStates(const DFA& dfa) {
-    set<int> reachable;
-    queue<int> q;
-    
-    q.push(dfa.initialState);
-    reachable.insert(dfa.initialState);
+// Function to remove useless states: those the initial state cannot reach
+// and those that cannot reach a final state (trap states). Moves into them
+// become -1 and the states left keep their order.
+DFA trimDFA(const DFA& dfa) {
+    if (dfa.initialState < 0 || dfa.initialState >= dfa.states) {
+        // Nothing can run: one state without moves
+        DFA empty{1, dfa.symbols, vector<vector<int>>(1, vector<int>(dfa.symbols, -1)), {}, 0};
+        return empty;
+    }
     
-    while (!q.empty()) {
-        int current = q.front();
-        q.pop();
-        
+    vector<pair<int, int>> edges;
+    for (int s = 0; s < dfa.states; s++) {
         for (int symbol = 0; symbol < dfa.symbols; symbol++) {
-            int next = dfa.transitions[current][symbol];
-            if (next != -1 && reachable.find(next) == reachable.end()) {
-                reachable.insert(next);
-                q.push(next);
-            }
+            int next = dfa.transitions[s][symbol];
+            if (next >= 0 && next < dfa.states) edges.emplace_back(s, next);
         }
     }
-    
-    return reachable;
+    vector<int> accepting;
+    for (int state : dfa.finalStates) {
+        if (state >= 0 && state < dfa.states) accepting.push_back(state);
+    }
+    vector<int> renumbered;
+    trimStates(dfa.states, edges, dfa.initialState, accepting, renumbered);
+
+    vector<int> stateMap(dfa.states, -1);
+    int kept = 0;
+    for (int s = 0; s < dfa.states; s++) {
+        if (renumbered[s] >= 0) stateMap[s] = kept++;
+    }
+
+    DFA trimmed;
+    trimmed.states = kept;
+    trimmed.symbols = dfa.symbols;
+    trimmed.transitions = vector<vector<int>>(kept, vector<int>(dfa.symbols, -1));
+    trimmed.initialState = stateMap[dfa.initialState];
+    for (int s = 0; s < dfa.states; s++) {
+        if (stateMap[s] == -1) continue;
+        for (int symbol = 0; symbol < dfa.symbols; symbol++) {
+            int next = dfa.transitions[s][symbol];
+            if (next >= 0 && next < dfa.states) trimmed.transitions[stateMap[s]][symbol] = stateMap[next];
+        }
+        if (dfa.finalStates.find(s) != dfa.finalStates.end()) trimmed.finalStates.insert(stateMap[s]);
+    }
+    return trimmed;
 }
 
 // Function to check if two states are distinguishable
@@ -52,7 +74,10 @@ bool areDistinguishable(int s1, int s2, const DFA& dfa, const vector<vector<bool
         int next1 = dfa.transitions[s1][symbol];
         int next2 = dfa.transitions[s2][symbol];
         
-        if (next1 != next2 && distinguished[next1][next2]) {
+        if (next1 == next2) continue;
+        // After trimming every state can still reach a final state, so a
+        // missing move is told apart from any move
+        if (next1 == -1 || next2 == -1 || distinguished[next1][next2]) {
             return true;
         }
     }
@@ -62,26 +87,20 @@ bool areDistinguishable(int s1, int s2, const DFA& dfa, const vector<vector<bool
 
 // Function to minimize DFA
 DFA minimizeDFA(const DFA& input_dfa) {
-    // Step 1: Remove unreachable states
-    set<int> reachable = getReachableStates(input_dfa);
-    
-    // Create mapping for new state numbers
-    map<int, int> stateMap;
-    int newStateCount = 0;
-    for (int state : reachable) {
-        stateMap[state] = newStateCount++;
-    }
+    // Step 1: Remove useless states
+    DFA trimmed_dfa = trimDFA(input_dfa);
+    const DFA& dfa = trimmed_dfa;
     
     // Step 2: Find distinguishable states
-    vector<vector<bool>> distinguished(input_dfa.states, vector<bool>(input_dfa.states, false));
+    vector<vector<bool>> distinguished(dfa.states, vector<bool>(dfa.states, false));
     bool changed;
     
     do {
         changed = false;
-        for (int s1 = 0; s1 < input_dfa.states; s1++) {
-            for (int s2 = s1 + 1; s2 < input_dfa.states; s2++) {
+        for (int s1 = 0; s1 < dfa.states; s1++) {
+            for (int s2 = s1 + 1; s2 < dfa.states; s2++) {
                 if (!distinguished[s1][s2] && !distinguished[s2][s1]) {
-                    if (areDistinguishable(s1, s2, input_dfa, distinguished)) {
+                    if (areDistinguishable(s1, s2, dfa, distinguished)) {
                         distinguished[s1][s2] = distinguished[s2][s1] = true;
                         changed = true;
                     }
@@ -91,17 +110,14 @@ DFA minimizeDFA(const DFA& input_dfa) {
     } while (changed);
     
     // Step 3: Combine equivalent states
-    vector<int> stateClass(input_dfa.states, -1);
+    vector<int> stateClass(dfa.states, -1);
     int classCount = 0;
     
-    for (int s = 0; s < input_dfa.states; s++) {
-        if (reachable.find(s) == reachable.end()) continue;
-        
+    for (int s = 0; s < dfa.states; s++) {
         if (stateClass[s] == -1) {
             stateClass[s] = classCount;
-            for (int t = s + 1; t < input_dfa.states; t++) {
-                if (reachable.find(t) != reachable.end() && 
-                    !distinguished[s][t] && !distinguished[t][s]) {
+            for (int t = s + 1; t < dfa.states; t++) {
+                if (!distinguished[s][t] && !distinguished[t][s]) {
                     stateClass[t] = classCount;
                 }
             }
@@ -112,17 +128,15 @@ DFA minimizeDFA(const DFA& input_dfa) {
     // Create minimized DFA
     DFA min_dfa;
     min_dfa.states = classCount;
-    min_dfa.symbols = input_dfa.symbols;
-    min_dfa.transitions = vector<vector<int>>(classCount, vector<int>(input_dfa.symbols));
-    min_dfa.initialState = stateClass[input_dfa.initialState];
+    min_dfa.symbols = dfa.symbols;
+    min_dfa.transitions = vector<vector<int>>(classCount, vector<int>(dfa.symbols));
+    min_dfa.initialState = stateClass[dfa.initialState];
     
     // Set transitions for minimized DFA
-    for (int s = 0; s < input_dfa.states; s++) {
-        if (reachable.find(s) == reachable.end()) continue;
-        
+    for (int s = 0; s < dfa.states; s++) {
         int oldClass = stateClass[s];
-        for (int symbol = 0; symbol < input_dfa.symbols; symbol++) {
-            int next = input_dfa.transitions[s][symbol];
+        for (int symbol = 0; symbol < dfa.symbols; symbol++) {
+            int next = dfa.transitions[s][symbol];
             if (next != -1) {
                 min_dfa.transitions[oldClass][symbol] = stateClass[next];
             } else {
@@ -130,7 +144,7 @@ DFA minimizeDFA(const DFA& input_dfa) {
             }
         }
         
-        if (input_dfa.finalStates.find(s) != input_dfa.finalStates.end()) {
+        if (dfa.finalStates.find(s) != dfa.finalStates.end()) {
             min_dfa.finalStates.insert(stateClass[s]);
         }
     }
@@ -138,6 +152,22 @@ DFA minimizeDFA(const DFA& input_dfa) {
     return min_dfa;
 }
 
+// Transition matrix of a deterministic SparseNFA, -1 where it has no move
+DFA toDFA(const SparseNFA& nfa) {
+    DFA dfa;
+    dfa.states = nfa.getNumStates();
+    dfa.symbols = nfa.getNumSymbols();
+    dfa.transitions = vector<vector<int>>(dfa.states, vector<int>(dfa.symbols, -1));
+    for (int s = 0; s < dfa.states; s++) {
+        for (uint32_t i = nfa.firstMove(s); i < nfa.lastMove(s); i++) {
+            dfa.transitions[s][nfa.moveSymbol(i)] = nfa.moveTarget(i);
+        }
+        if (nfa.isAccepting(s)) dfa.finalStates.insert(s);
+    }
+    dfa.initialState = nfa.getStartState();
+    return dfa;
+}
+
 // Function to display DFA transition table
 void displayDFA(const DFA& dfa) {
     cout << "\nDFA Transition Table:\n";
@@ -161,44 +191,70 @@ void displayDFA(const DFA& dfa) {
     }
 }
 
-int main() {
+// DFA of a definition file (see automaton_file.h); a missing move becomes -1
+bool loadDFA(const string& path, DFA& dfa) {
+    SparseNFA nfa;
+    string error;
+    if (!loadSparseNFA(path, nfa, error)) {
+        cerr << "ERROR: " << error << "\n";
+        return false;
+    }
+    if (!nfa.isDeterministic()) {
+        cerr << "ERROR: " << path << ": not a DFA (e-moves or several targets on one symbol)\n";
+        return false;
+    }
+    dfa = toDFA(nfa);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
     DFA dfa;
-    
-    // Input DFA specifications
-    cout << "Enter number of states: ";
-    cin >> dfa.states;
-    
-    cout << "Enter number of symbols: ";
-    cin >> dfa.symbols;
-    
-    // Initialize transition table
-    dfa.transitions = vector<vector<int>>(dfa.states, vector<int>(dfa.symbols));
-    
-    // Input transitions
-    cout << "\nEnter transitions (-1 for no transition):\n";
-    for (int i = 0; i < dfa.states; i++) {
-        cout << "For state " << i << ":\n";
-        for (int j = 0; j < dfa.symbols; j++) {
-            cout << "On input " << (char)('a' + j) << ": ";
-            cin >> dfa.transitions[i][j];
-        }
+
+    // Option: -f <file> reads the DFA from a definition file instead of the prompts
+    string definitionPath;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (string(argv[i]) == "-f") definitionPath = argv[i + 1];
     }
-    
-    // Input final states
-    int numFinal;
-    cout << "\nEnter number of final states: ";
-    cin >> numFinal;
-    cout << "Enter final states: ";
-    for (int i = 0; i < numFinal; i++) {
-        int state;
-        cin >> state;
-        dfa.finalStates.insert(state);
+
+    if (!definitionPath.empty()) {
+        if (!loadDFA(definitionPath, dfa)) return 1;
+    } else {
+        // Input DFA specifications
+        cout << "Enter number of states: ";
+        cin >> dfa.states;
+        
+        cout << "Enter number of symbols: ";
+        cin >> dfa.symbols;
+        
+        // Initialize transition table
+        dfa.transitions = vector<vector<int>>(dfa.states, vector<int>(dfa.symbols));
+        
+        // Input transitions
+        cout << "\nEnter transitions (-1 for no transition):\n";
+        for (int i = 0; i < dfa.states; i++) {
+            cout << "For state " << i << ":\n";
+            for (int j = 0; j < dfa.symbols; j++) {
+                cout << "On input " << (char)('a' + j) << ": ";
+                cin >> dfa.transitions[i][j];
+            }
+        }
+        
+        // Input final states
+        int numFinal;
+        cout << "\nEnter number of final states: ";
+        cin >> numFinal;
+        cout << "Enter final states: ";
+        for (int i = 0; i < numFinal; i++) {
+            int state;
+            cin >> state;
+            dfa.finalStates.insert(state);
+        }
+        
+        // Input initial state
+        cout << "Enter initial state: ";
+        cin >> dfa.initialState;
     }
     
-    // Input initial state
-    cout << "Enter initial state: ";
-    cin >> dfa.initialState;
-    
     cout << "\nOriginal DFA:";
     displayDFA(dfa);
     
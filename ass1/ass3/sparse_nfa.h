@@ -0,0 +1,259 @@
+#ifndef SPARSE_NFA_H
+#define SPARSE_NFA_H
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "automaton_file.h"
+
+using namespace std;
+
+// Symbols are stored in one byte per move
+const int SPARSE_NFA_MAX_SYMBOLS = 256;
+
+// Sorted targets of one state on one symbol (or its e-moves): a slice of a
+// packed target array, iterated like a container
+class StateRange {
+private:
+    const int* first;
+    const int* last;
+
+public:
+    StateRange(const int* begin, const int* end) : first(begin), last(end) {}
+    const int* begin() const { return first; }
+    const int* end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+    int operator[](size_t i) const { return first[i]; }
+};
+
+// NFA in compressed sparse row form. The moves of all states sit in two
+// packed arrays sorted by (state, symbol, target), symbols and targets side by
+// side, and moveOffsets[s] says where state s begins. e-moves have their own
+// offsets and target array. Memory is 4 bytes per state for each offset
+// table plus 5 bytes per move and 4 per e-move, so a million states with two
+// moves each take about 18 MB. A states x symbols table of empty std::set
+// cells takes 48 MB per symbol before it holds a single move.
+//
+// Looking up one (state, symbol) scans the state's own moves, which is a few
+// entries for the sparse automata this is meant for; with many moves per
+// state it switches to a binary search.
+class SparseNFA {
+private:
+    int numStates = 0;
+    int numSymbols = 0;
+    int start = 0;
+    vector<uint32_t> moveOffsets;       // numStates + 1 entries
+    vector<uint8_t> moveSymbols;
+    vector<int> moveTargets;
+    vector<uint32_t> epsilonOffsets;    // numStates + 1 entries
+    vector<int> epsilonTargets;
+    vector<bool> accepting;
+
+    void checkSymbols() const {
+        if (numSymbols > SPARSE_NFA_MAX_SYMBOLS) {
+            throw invalid_argument("SparseNFA: more than " + to_string(SPARSE_NFA_MAX_SYMBOLS) + " symbols");
+        }
+    }
+
+    // Bucket the moves by state (counting sort), then sort and deduplicate
+    // each state's slice in place
+    void build(const vector<AutomatonMove>& moves) {
+        moveOffsets.assign(numStates + 1, 0);
+        epsilonOffsets.assign(numStates + 1, 0);
+        for (const AutomatonMove& move : moves) {
+            if (move.symbol == AUTOMATON_EPSILON) epsilonOffsets[move.from + 1]++;
+            else moveOffsets[move.from + 1]++;
+        }
+        for (int s = 0; s < numStates; s++) {
+            moveOffsets[s + 1] += moveOffsets[s];
+            epsilonOffsets[s + 1] += epsilonOffsets[s];
+        }
+
+        // Symbol and target packed into one key while sorting
+        vector<uint64_t> keys(moveOffsets[numStates]);
+        epsilonTargets.resize(epsilonOffsets[numStates]);
+        vector<uint32_t> moveFill(moveOffsets.begin(), moveOffsets.end() - 1);
+        vector<uint32_t> epsilonFill(epsilonOffsets.begin(), epsilonOffsets.end() - 1);
+        for (const AutomatonMove& move : moves) {
+            if (move.symbol == AUTOMATON_EPSILON) {
+                epsilonTargets[epsilonFill[move.from]++] = move.to;
+            } else {
+                keys[moveFill[move.from]++] = ((uint64_t)move.symbol << 32) | (uint32_t)move.to;
+            }
+        }
+
+        // Sort each slice, then squeeze out repeats (which shifts the offsets)
+        uint32_t moveKept = 0, epsilonKept = 0;
+        for (int s = 0; s < numStates; s++) {
+            uint32_t begin = moveOffsets[s], end = moveOffsets[s + 1];
+            sort(keys.begin() + begin, keys.begin() + end);
+            moveOffsets[s] = moveKept;
+            for (uint32_t i = begin; i < end; i++) {
+                if (i == begin || keys[i] != keys[i - 1]) keys[moveKept++] = keys[i];
+            }
+
+            begin = epsilonOffsets[s];
+            end = epsilonOffsets[s + 1];
+            sort(epsilonTargets.begin() + begin, epsilonTargets.begin() + end);
+            epsilonOffsets[s] = epsilonKept;
+            for (uint32_t i = begin; i < end; i++) {
+                if (i == begin || epsilonTargets[i] != epsilonTargets[i - 1]) {
+                    epsilonTargets[epsilonKept++] = epsilonTargets[i];
+                }
+            }
+        }
+        moveOffsets[numStates] = moveKept;
+        epsilonOffsets[numStates] = epsilonKept;
+        epsilonTargets.resize(epsilonKept);
+        epsilonTargets.shrink_to_fit();
+
+        moveSymbols.resize(moveKept);
+        moveTargets.resize(moveKept);
+        for (uint32_t i = 0; i < moveKept; i++) {
+            moveSymbols[i] = (uint8_t)(keys[i] >> 32);
+            moveTargets[i] = (int)(uint32_t)keys[i];
+        }
+    }
+
+public:
+    SparseNFA() : moveOffsets(1, 0), epsilonOffsets(1, 0) {}
+
+    // Moves may repeat and come in any order; moves and accept states
+    // outside the automaton are ignored. Throws invalid_argument for more
+    // than SPARSE_NFA_MAX_SYMBOLS symbols.
+    SparseNFA(int states, int symbols, int startState, const vector<AutomatonMove>& moves,
+              const vector<int>& acceptStates) :
+        numStates(max(0, states)), numSymbols(max(0, symbols)), start(startState), accepting(numStates, false) {
+        checkSymbols();
+        vector<AutomatonMove> valid;
+        valid.reserve(moves.size());
+        for (const AutomatonMove& move : moves) {
+            if (move.from >= 0 && move.from < numStates && move.to >= 0 && move.to < numStates &&
+                (move.symbol == AUTOMATON_EPSILON || (move.symbol >= 0 && move.symbol < numSymbols))) {
+                valid.push_back(move);
+            }
+        }
+        build(valid);
+        for (int state : acceptStates) {
+            if (state >= 0 && state < numStates) accepting[state] = true;
+        }
+    }
+
+    // A loaded definition is already checked, so no filtering pass
+    explicit SparseNFA(const AutomatonDefinition& definition) :
+        numStates(definition.states), numSymbols(definition.symbols), start(definition.start),
+        accepting(numStates, false) {
+        checkSymbols();
+        build(definition.moves);
+        for (int state : definition.accepting) accepting[state] = true;
+    }
+
+    int getNumStates() const { return numStates; }
+    int getNumSymbols() const { return numSymbols; }
+    int getStartState() const { return start; }
+    bool isAccepting(int state) const { return accepting[state]; }
+
+    size_t moveCount() const { return moveTargets.size(); }
+    size_t epsilonCount() const { return epsilonTargets.size(); }
+    bool hasEpsilon() const { return !epsilonTargets.empty(); }
+
+    size_t memoryBytes() const {
+        return (moveOffsets.size() + epsilonOffsets.size()) * sizeof(uint32_t) + moveSymbols.size() +
+               (moveTargets.size() + epsilonTargets.size()) * sizeof(int) + accepting.size() / 8;
+    }
+
+    // Targets of state on symbol, in increasing order
+    StateRange moves(int state, int symbol) const {
+        uint32_t begin = moveOffsets[state], end = moveOffsets[state + 1];
+        const uint8_t* symbols = moveSymbols.data();
+        if (end - begin <= 16) {
+            while (begin < end && symbols[begin] < symbol) begin++;
+            uint32_t stop = begin;
+            while (stop < end && symbols[stop] == symbol) stop++;
+            end = stop;
+        } else {
+            begin = (uint32_t)(lower_bound(symbols + begin, symbols + end, (uint8_t)symbol) - symbols);
+            end = (uint32_t)(upper_bound(symbols + begin, symbols + end, (uint8_t)symbol) - symbols);
+        }
+        return StateRange(moveTargets.data() + begin, moveTargets.data() + end);
+    }
+
+    // e-move targets of state, in increasing order
+    StateRange epsilonMoves(int state) const {
+        return StateRange(epsilonTargets.data() + epsilonOffsets[state],
+                          epsilonTargets.data() + epsilonOffsets[state + 1]);
+    }
+
+    // All moves of state as parallel arrays [first, last) of symbols and
+    // targets, sorted by symbol then target
+    uint32_t firstMove(int state) const { return moveOffsets[state]; }
+    uint32_t lastMove(int state) const { return moveOffsets[state + 1]; }
+    int moveSymbol(uint32_t i) const { return moveSymbols[i]; }
+    int moveTarget(uint32_t i) const { return moveTargets[i]; }
+
+    // At most one target per state and symbol, and no e-moves
+    bool isDeterministic() const {
+        if (hasEpsilon()) return false;
+        for (int s = 0; s < numStates; s++) {
+            for (uint32_t i = moveOffsets[s] + 1; i < moveOffsets[s + 1]; i++) {
+                if (moveSymbols[i] == moveSymbols[i - 1]) return false;
+            }
+        }
+        return true;
+    }
+};
+
+// Load a definition file straight into a SparseNFA
+inline bool loadSparseNFA(const string& path, SparseNFA& result, string& error) {
+    AutomatonDefinition definition;
+    if (!loadAutomatonFile(path, definition, error)) return false;
+    result = SparseNFA(definition);
+    return true;
+}
+
+// Targets of `state` in `column` of either table form the ass3 programs use:
+// the digit-string tables of q2 and q3 ("-" or characters '0' + state) or a
+// SparseNFA. Column numSymbols holds the e-moves, as in q3's table.
+template <typename F>
+void forEachTarget(const vector<vector<string>>& table, int state, int column, F f) {
+    const string& cell = table[state][column];
+    if (cell == "-") return;
+    for (char c : cell) f(c - '0');
+}
+
+template <typename F>
+void forEachTarget(const SparseNFA& nfa, int state, int column, F f) {
+    StateRange targets = (column == nfa.getNumSymbols()) ? nfa.epsilonMoves(state) : nfa.moves(state, column);
+    for (int target : targets) f(target);
+}
+
+// SparseNFA of a digit-string table starting in state 0; with one column
+// more than symbols, the last one holds e-moves. The tables carry no accept
+// states, so every state is made accepting.
+inline SparseNFA digitTableNFA(const vector<vector<string>>& table, int symbols) {
+    vector<AutomatonMove> moves;
+    for (size_t s = 0; s < table.size(); s++) {
+        for (size_t column = 0; column < table[s].size(); column++) {
+            int symbol = ((int)column == symbols) ? AUTOMATON_EPSILON : (int)column;
+            forEachTarget(table, (int)s, (int)column, [&](int target) {
+                moves.push_back(AutomatonMove{(int)s, symbol, target});
+            });
+        }
+    }
+    vector<int> accepting(table.size());
+    for (size_t s = 0; s < table.size(); s++) accepting[s] = (int)s;
+    return SparseNFA((int)table.size(), symbols, 0, moves, accepting);
+}
+
+// Cell text of those tables: "-" or the targets as characters '0' + state
+template <typename Table>
+string digitCell(const Table& table, int state, int column) {
+    string cell;
+    forEachTarget(table, state, column, [&](int target) { cell += (char)('0' + target); });
+    return cell.empty() ? "-" : cell;
+}
+
+#endif // SPARSE_NFA_H
@@ -0,0 +1,152 @@
+#ifndef TRIM_H
+#define TRIM_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "sparse_nfa.h"
+
+using namespace std;
+
+// Trimming: dropping the states no accepted word passes through, before any
+// expensive work. A state is useful if it is reachable from the start state
+// and an accept state is reachable from it, with symbols ignored and e-moves
+// counted like any other move. Both searches are breadth-first over a
+// compressed sparse row graph.
+
+// Successor lists of a graph over states 0..states-1, in compressed sparse rows
+struct StateGraph {
+    vector<uint32_t> offsets;       // states + 1 entries
+    vector<int> targets;
+
+    int states() const { return (int)offsets.size() - 1; }
+};
+
+// Graph of the given edges, or of the edges reversed
+inline StateGraph edgeGraph(int states, const vector<pair<int, int>>& edges, bool reverse) {
+    StateGraph graph;
+    graph.offsets.assign(states + 1, 0);
+    for (const auto& edge : edges) graph.offsets[(reverse ? edge.second : edge.first) + 1]++;
+    for (int s = 0; s < states; s++) graph.offsets[s + 1] += graph.offsets[s];
+    graph.targets.resize(edges.size());
+    vector<uint32_t> fill(graph.offsets.begin(), graph.offsets.end() - 1);
+    for (const auto& edge : edges) {
+        int from = reverse ? edge.second : edge.first;
+        graph.targets[fill[from]++] = reverse ? edge.first : edge.second;
+    }
+    return graph;
+}
+
+// States reachable from any of the sources (1) or not (0). The queue is a
+// plain array: every state enters it at most once.
+inline vector<uint8_t> reachableFrom(const StateGraph& graph, const vector<int>& sources) {
+    vector<uint8_t> seen(graph.states(), 0);
+    vector<int> queue;
+    queue.reserve(graph.states());
+    for (int s : sources) {
+        if (!seen[s]) {
+            seen[s] = 1;
+            queue.push_back(s);
+        }
+    }
+    for (size_t head = 0; head < queue.size(); head++) {
+        int s = queue[head];
+        for (uint32_t e = graph.offsets[s]; e < graph.offsets[s + 1]; e++) {
+            int target = graph.targets[e];
+            if (!seen[target]) {
+                seen[target] = 1;
+                queue.push_back(target);
+            }
+        }
+    }
+    return seen;
+}
+
+// New number of every state after trimming, -1 for the dropped ones. The
+// start state is always kept and becomes state 0, so an automaton with an
+// empty language trims to a lone start state; the other survivors keep their
+// order. Returns the number of states kept.
+inline int trimStates(int states, const vector<pair<int, int>>& edges, int start,
+                      const vector<int>& accepting, vector<int>& renumbered) {
+    vector<uint8_t> forward = reachableFrom(edgeGraph(states, edges, false), {start});
+    vector<uint8_t> backward = reachableFrom(edgeGraph(states, edges, true), accepting);
+    renumbered.assign(states, -1);
+    renumbered[start] = 0;
+    int kept = 1;
+    for (int s = 0; s < states; s++) {
+        if (s != start && forward[s] && backward[s]) renumbered[s] = kept++;
+    }
+    return kept;
+}
+
+// A SparseNFA without its useless states, and where each state came from
+struct TrimmedNFA {
+    SparseNFA nfa;
+    vector<int> original;           // New state -> state of the input
+    int inputStates = 0;
+
+    // False if every state was kept under its own number
+    bool changed() const {
+        for (size_t s = 0; s < original.size(); s++) {
+            if (original[s] != (int)s) return true;
+        }
+        return (int)original.size() != inputStates;
+    }
+
+    // What changed, for the programs' output, e.g.
+    // "Trimmed 2 useless states; kept (new=old): 0=0 1=2 2=3"
+    string describe() const {
+        string text = "Trimmed " + to_string(inputStates - (int)original.size()) + " useless states; kept (new=old):";
+        for (size_t s = 0; s < original.size(); s++) text += " " + to_string(s) + "=" + to_string(original[s]);
+        return text;
+    }
+};
+
+inline TrimmedNFA trimNFA(const SparseNFA& nfa) {
+    int states = nfa.getNumStates();
+    TrimmedNFA result;
+    result.inputStates = states;
+    if (nfa.getStartState() < 0 || nfa.getStartState() >= states) {
+        // No run can start, so nothing is useful: one state that accepts nothing
+        result.nfa = SparseNFA(1, nfa.getNumSymbols(), 0, {}, {});
+        result.original.assign(1, nfa.getStartState());
+        return result;
+    }
+
+    vector<pair<int, int>> edges;
+    edges.reserve(nfa.moveCount() + nfa.epsilonCount());
+    vector<int> accepting;
+    for (int s = 0; s < states; s++) {
+        for (uint32_t i = nfa.firstMove(s); i < nfa.lastMove(s); i++) edges.emplace_back(s, nfa.moveTarget(i));
+        for (int target : nfa.epsilonMoves(s)) edges.emplace_back(s, target);
+        if (nfa.isAccepting(s)) accepting.push_back(s);
+    }
+    vector<int> renumbered;
+    int kept = trimStates(states, edges, nfa.getStartState(), accepting, renumbered);
+
+    // Every renumbered move is in range, so the trimmed automaton is built
+    // like a loaded definition, without the filtering pass
+    AutomatonDefinition trimmed;
+    trimmed.states = kept;
+    trimmed.symbols = nfa.getNumSymbols();
+    trimmed.moves.reserve(edges.size());
+    result.original.assign(kept, 0);
+    for (int s = 0; s < states; s++) {
+        int from = renumbered[s];
+        if (from < 0) continue;
+        result.original[from] = s;
+        if (nfa.isAccepting(s)) trimmed.accepting.push_back(from);
+        for (uint32_t i = nfa.firstMove(s); i < nfa.lastMove(s); i++) {
+            int to = renumbered[nfa.moveTarget(i)];
+            if (to >= 0) trimmed.moves.push_back(AutomatonMove{from, nfa.moveSymbol(i), to});
+        }
+        for (int target : nfa.epsilonMoves(s)) {
+            int to = renumbered[target];
+            if (to >= 0) trimmed.moves.push_back(AutomatonMove{from, AUTOMATON_EPSILON, to});
+        }
+    }
+    result.nfa = SparseNFA(trimmed);
+    return result;
+}
+
+#endif // TRIM_H
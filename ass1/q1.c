@@ -1,24 +1,20 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symcount.h"
 
-void analyzeBinaryString(char *binaryStr) {
-    int count0 = 0, count1 = 0;
-
-    // Traverse the binary string and count 0s and 1s
-    while (*binaryStr != '\0') {
-        if (*binaryStr == '0') {
-            count0++;
-        } else if (*binaryStr == '1') {
-            count1++;
-        } else {
-            printf("Invalid input: Binary string should contain only 0s and 1s.\n");
-            return;
-        }
-        binaryStr++;
+// Print the counts and parity verdicts for a scanned binary string
+void reportBinaryCounts(const SymbolCounts *counts) {
+    if (counts->invalidPos != -1) {
+        printf("Invalid input: Binary string should contain only 0s and 1s.\n");
+        return;
     }
 
+    long long count0 = counts->count0, count1 = counts->count1;
+
     // Output the counts
-    printf("Number of 0s: %d\n", count0);
-    printf("Number of 1s: %d\n", count1);
+    printf("Number of 0s: %lld\n", count0);
+    printf("Number of 1s: %lld\n", count1);
 
     // Check if the counts of 0s and 1s are equal
     if (count0 == count1) {
@@ -42,11 +38,106 @@ void analyzeBinaryString(char *binaryStr) {
     }
 }
 
-int main() {
+void analyzeBinaryString(char *binaryStr) {
+    SymbolCounts counts;
+    initSymbolCounts(&counts);
+
+    // Count 0s and 1s, stopping at the first character that is neither
+    countSymbols(binaryStr, strlen(binaryStr), '0', '1', &counts);
+    reportBinaryCounts(&counts);
+}
+
+// Analyze a whole file as one binary string ("-" reads stdin).
+// threads != 1 splits a regular file across that many threads (0 = all CPUs).
+int analyzeBinaryFile(const char *path, int threads) {
+    FILE *fp = (strcmp(path, "-") == 0) ? stdin : fopen(path, "rb");
+    if (fp == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    SymbolCounts counts;
+    initSymbolCounts(&counts);
+    int status;
+    if (threads != 1 && fp != stdin) {
+        fclose(fp);
+        status = countSymbolsFileParallel(path, threads, '0', '1', &counts);
+    } else {
+        status = countSymbolsStream(fp, '0', '1', &counts);
+        if (fp != stdin) fclose(fp);
+    }
+    if (status != 0) {
+        perror(path);
+        return 1;
+    }
+
+    reportBinaryCounts(&counts);
+    return 0;
+}
+
+// Batch mode: one compact result line per record, e.g. "2 2 equal even even"
+// or "invalid <offset> <char>"
+void classifyBinaryRecord(const char *line, size_t len, void *context) {
+    (void)context;
+    SymbolCounts counts;
+    initSymbolCounts(&counts);
+    countSymbols(line, len, '0', '1', &counts);
+
+    if (counts.invalidPos != -1) {
+        printf("invalid %lld %c\n", counts.invalidPos, counts.invalidChar);
+    } else {
+        printf("%lld %lld %s %s %s\n", counts.count0, counts.count1,
+               counts.count0 == counts.count1 ? "equal" : "unequal",
+               counts.count0 % 2 == 0 ? "even" : "odd",
+               counts.count1 % 2 == 0 ? "even" : "odd");
+    }
+}
+
+// Classify every line of a file ("-" reads stdin) as a separate binary string
+int classifyBinaryLines(const char *path) {
+    FILE *fp = (strcmp(path, "-") == 0) ? stdin : fopen(path, "rb");
+    if (fp == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    setvbuf(stdout, NULL, _IOFBF, SYMCOUNT_BATCH_BUFFER_SIZE);
+    int status = forEachLine(fp, classifyBinaryRecord, NULL);
+    if (fp != stdin) fclose(fp);
+    fflush(stdout);
+    if (status != 0) {
+        perror(path);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    // File mode: q1 -f <file> [-j <threads>] streams the file instead of prompting
+    // Batch mode: q1 -b <file> classifies each line separately
+    const char *path = NULL;
+    const char *batchPath = NULL;
+    int threads = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "-f") == 0) {
+            path = argv[i + 1];
+        } else if (strcmp(argv[i], "-j") == 0) {
+            threads = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "-b") == 0) {
+            batchPath = argv[i + 1];
+        }
+    }
+    if (batchPath != NULL) {
+        return classifyBinaryLines(batchPath);
+    }
+    if (path != NULL) {
+        return analyzeBinaryFile(path, threads);
+    }
+
     char binaryStr[100];
 
     printf("Enter a binary string: ");
-    scanf("%s", binaryStr);
+    scanf("%99s", binaryStr);
 
     analyzeBinaryString(binaryStr);
 
@@ -1,25 +1,20 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include "symcount.h"
 
-void analyzeCharacterString(const char *charString) {
-    int countA = 0, countB = 0;
-    
-    // Count the number of 'a's and 'b's
-    for (const char *ptr = charString; *ptr != '\0'; ++ptr) {
-        if (*ptr == 'a') {
-            countA++;
-        } else if (*ptr == 'b') {
-            countB++;
-        }
-        else {
-            printf("Error: Invalid character '%c' found. Only 'a' and 'b' are allowed.\n", *ptr);
-            return;
-        }
+// Print the counts and parity verdicts for a scanned a/b string
+void reportCharacterCounts(const SymbolCounts *counts) {
+    if (counts->invalidPos != -1) {
+        printf("Error: Invalid character '%c' found. Only 'a' and 'b' are allowed.\n", counts->invalidChar);
+        return;
     }
 
+    long long countA = counts->count0, countB = counts->count1;
+
     // Display counts of 'a' and 'b'
-    printf("Number of 'a's: %d\n", countA);
-    printf("Number of 'b's: %d\n", countB);
+    printf("Number of 'a's: %lld\n", countA);
+    printf("Number of 'b's: %lld\n", countB);
 
     // Check if the count of 'a's and 'b's are equal
     if (countA == countB) {
@@ -43,11 +38,106 @@ void analyzeCharacterString(const char *charString) {
     }
 }
 
-int main() {
+void analyzeCharacterString(const char *charString) {
+    SymbolCounts counts;
+    initSymbolCounts(&counts);
+    
+    // Count the number of 'a's and 'b's, stopping at the first other character
+    countSymbols(charString, strlen(charString), 'a', 'b', &counts);
+    reportCharacterCounts(&counts);
+}
+
+// Analyze a whole file as one a/b string ("-" reads stdin).
+// threads != 1 splits a regular file across that many threads (0 = all CPUs).
+int analyzeCharacterFile(const char *path, int threads) {
+    FILE *fp = (strcmp(path, "-") == 0) ? stdin : fopen(path, "rb");
+    if (fp == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    SymbolCounts counts;
+    initSymbolCounts(&counts);
+    int status;
+    if (threads != 1 && fp != stdin) {
+        fclose(fp);
+        status = countSymbolsFileParallel(path, threads, 'a', 'b', &counts);
+    } else {
+        status = countSymbolsStream(fp, 'a', 'b', &counts);
+        if (fp != stdin) fclose(fp);
+    }
+    if (status != 0) {
+        perror(path);
+        return 1;
+    }
+
+    reportCharacterCounts(&counts);
+    return 0;
+}
+
+// Batch mode: one compact result line per record, e.g. "2 2 equal even even"
+// or "invalid <offset> <char>"
+void classifyCharacterRecord(const char *line, size_t len, void *context) {
+    (void)context;
+    SymbolCounts counts;
+    initSymbolCounts(&counts);
+    countSymbols(line, len, 'a', 'b', &counts);
+
+    if (counts.invalidPos != -1) {
+        printf("invalid %lld %c\n", counts.invalidPos, counts.invalidChar);
+    } else {
+        printf("%lld %lld %s %s %s\n", counts.count0, counts.count1,
+               counts.count0 == counts.count1 ? "equal" : "unequal",
+               counts.count0 % 2 == 0 ? "even" : "odd",
+               counts.count1 % 2 == 0 ? "even" : "odd");
+    }
+}
+
+// Classify every line of a file ("-" reads stdin) as a separate a/b string
+int classifyCharacterLines(const char *path) {
+    FILE *fp = (strcmp(path, "-") == 0) ? stdin : fopen(path, "rb");
+    if (fp == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    setvbuf(stdout, NULL, _IOFBF, SYMCOUNT_BATCH_BUFFER_SIZE);
+    int status = forEachLine(fp, classifyCharacterRecord, NULL);
+    if (fp != stdin) fclose(fp);
+    fflush(stdout);
+    if (status != 0) {
+        perror(path);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    // File mode: q2 -f <file> [-j <threads>] streams the file instead of prompting
+    // Batch mode: q2 -b <file> classifies each line separately
+    const char *path = NULL;
+    const char *batchPath = NULL;
+    int threads = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "-f") == 0) {
+            path = argv[i + 1];
+        } else if (strcmp(argv[i], "-j") == 0) {
+            threads = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "-b") == 0) {
+            batchPath = argv[i + 1];
+        }
+    }
+    if (batchPath != NULL) {
+        return classifyCharacterLines(batchPath);
+    }
+    if (path != NULL) {
+        return analyzeCharacterFile(path, threads);
+    }
+
     char charString[100];
     
     printf("Enter a string containing only 'a' and 'b': ");
-    scanf("%s", charString);
+    scanf("%99s", charString);
 
     analyzeCharacterString(charString);
 
@@ -0,0 +1,405 @@
+#ifndef SYMCOUNT_H
+#define SYMCOUNT_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/types.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define SYMCOUNT_X86 1
+#include <immintrin.h>
+#endif
+
+// Result of scanning a string over a two-symbol alphabet
+typedef struct {
+    long long count0;       // Occurrences of the first symbol
+    long long count1;       // Occurrences of the second symbol
+    long long invalidPos;   // Offset of the first byte outside the alphabet, -1 if none
+    char invalidChar;       // That byte
+} SymbolCounts;
+
+static inline void initSymbolCounts(SymbolCounts *counts) {
+    counts->count0 = 0;
+    counts->count1 = 0;
+    counts->invalidPos = -1;
+    counts->invalidChar = '\0';
+}
+
+// Plain byte-at-a-time loop, also used for the tails of the vector kernels
+static inline size_t countSymbolsScalar(const char *buf, size_t len, char sym0, char sym1,
+                                        SymbolCounts *counts) {
+    size_t i;
+    for (i = 0; i < len; i++) {
+        if (buf[i] == sym0) {
+            counts->count0++;
+        } else if (buf[i] == sym1) {
+            counts->count1++;
+        } else {
+            counts->invalidPos = (long long)i;
+            counts->invalidChar = buf[i];
+            return i;
+        }
+    }
+    return len;
+}
+
+#ifdef SYMCOUNT_X86
+
+// Each vector kernel handles whole 64-byte blocks and returns how many bytes it
+// consumed. It stops in front of the first block holding an invalid byte and
+// leaves that block to the scalar loop, so the error is found at the same place.
+
+static inline size_t countSymbolsSSE2(const char *buf, size_t len, char sym0, char sym1,
+                                      SymbolCounts *counts) {
+    const __m128i v0 = _mm_set1_epi8(sym0);
+    const __m128i v1 = _mm_set1_epi8(sym1);
+    size_t i = 0;
+
+    for (; i + 64 <= len; i += 64) {
+        unsigned long long valid = 0, ones = 0;
+        int k;
+        for (k = 0; k < 4; k++) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(buf + i + 16 * k));
+            __m128i eq1 = _mm_cmpeq_epi8(v, v1);
+            __m128i ok = _mm_or_si128(_mm_cmpeq_epi8(v, v0), eq1);
+            valid |= (unsigned long long)(unsigned)_mm_movemask_epi8(ok) << (16 * k);
+            ones |= (unsigned long long)(unsigned)_mm_movemask_epi8(eq1) << (16 * k);
+        }
+        if (valid != ~0ULL) break;
+        int n1 = __builtin_popcountll(ones);
+        counts->count1 += n1;
+        counts->count0 += 64 - n1;
+    }
+    return i;
+}
+
+__attribute__((target("avx2,popcnt")))
+static inline size_t countSymbolsAVX2(const char *buf, size_t len, char sym0, char sym1,
+                                      SymbolCounts *counts) {
+    const __m256i v0 = _mm256_set1_epi8(sym0);
+    const __m256i v1 = _mm256_set1_epi8(sym1);
+    size_t i = 0;
+
+    for (; i + 64 <= len; i += 64) {
+        __m256i lo = _mm256_loadu_si256((const __m256i *)(buf + i));
+        __m256i hi = _mm256_loadu_si256((const __m256i *)(buf + i + 32));
+        __m256i eq1Lo = _mm256_cmpeq_epi8(lo, v1);
+        __m256i eq1Hi = _mm256_cmpeq_epi8(hi, v1);
+        __m256i okLo = _mm256_or_si256(_mm256_cmpeq_epi8(lo, v0), eq1Lo);
+        __m256i okHi = _mm256_or_si256(_mm256_cmpeq_epi8(hi, v0), eq1Hi);
+        if (!_mm256_testc_si256(_mm256_and_si256(okLo, okHi), _mm256_set1_epi8(-1))) break;
+        int n1 = __builtin_popcount((unsigned)_mm256_movemask_epi8(eq1Lo)) +
+                 __builtin_popcount((unsigned)_mm256_movemask_epi8(eq1Hi));
+        counts->count1 += n1;
+        counts->count0 += 64 - n1;
+    }
+    return i;
+}
+
+__attribute__((target("avx512f,avx512bw,popcnt")))
+static inline size_t countSymbolsAVX512(const char *buf, size_t len, char sym0, char sym1,
+                                        SymbolCounts *counts) {
+    const __m512i v0 = _mm512_set1_epi8(sym0);
+    const __m512i v1 = _mm512_set1_epi8(sym1);
+    size_t i = 0;
+
+    for (; i + 64 <= len; i += 64) {
+        __m512i v = _mm512_loadu_si512((const void *)(buf + i));
+        __mmask64 eq1 = _mm512_cmpeq_epi8_mask(v, v1);
+        __mmask64 ok = _mm512_cmpeq_epi8_mask(v, v0) | eq1;
+        if (ok != ~0ULL) break;
+        int n1 = __builtin_popcountll(eq1);
+        counts->count1 += n1;
+        counts->count0 += 64 - n1;
+    }
+    return i;
+}
+
+typedef size_t (*SymbolCountKernel)(const char *, size_t, char, char, SymbolCounts *);
+
+static SymbolCountKernel symbolCountKernel;
+static pthread_once_t symbolCountKernelOnce = PTHREAD_ONCE_INIT;
+
+static void pickSymbolCountKernel(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw")) {
+        symbolCountKernel = countSymbolsAVX512;
+    } else if (__builtin_cpu_supports("avx2")) {
+        symbolCountKernel = countSymbolsAVX2;
+    } else {
+        symbolCountKernel = countSymbolsSSE2;
+    }
+}
+
+// Pick the widest kernel the running CPU supports. Resolved once through
+// pthread_once, since the parallel file counter calls this from several
+// threads at the same time.
+static inline SymbolCountKernel selectSymbolCountKernel(void) {
+    pthread_once(&symbolCountKernelOnce, pickSymbolCountKernel);
+    return symbolCountKernel;
+}
+
+#endif // SYMCOUNT_X86
+
+// Count sym0 and sym1 in buf[0..len) and stop at the first other byte.
+// Counts are added to what is already in counts; invalidPos is relative to buf.
+static inline void countSymbols(const char *buf, size_t len, char sym0, char sym1,
+                                SymbolCounts *counts) {
+    size_t done = 0;
+#ifdef SYMCOUNT_X86
+    done = selectSymbolCountKernel()(buf, len, sym0, sym1, counts);
+#endif
+    size_t stop = countSymbolsScalar(buf + done, len - done, sym0, sym1, counts);
+    if (counts->invalidPos != -1) {
+        counts->invalidPos = (long long)(done + stop);
+    }
+}
+
+// Size of the buffer used to stream files through countSymbols
+#define SYMCOUNT_CHUNK_SIZE (1 << 20)
+
+// Count a whole stream chunk by chunk with the counters carried across chunks.
+// One trailing line break ("\n" or "\r\n") is not part of the string.
+// invalidPos is the offset in the stream. Returns -1 on a read error.
+static inline int countSymbolsStream(FILE *fp, char sym0, char sym1, SymbolCounts *counts) {
+    char *buf = (char *)malloc(SYMCOUNT_CHUNK_SIZE);
+    size_t held = 0;        // Line break bytes carried over from the previous chunk
+    long long offset = 0;   // Stream offset of buf[0]
+
+    if (buf == NULL) return -1;
+
+    for (;;) {
+        size_t got = fread(buf + held, 1, SYMCOUNT_CHUNK_SIZE - held, fp);
+        if (got == 0) break;
+        size_t len = held + got;
+
+        // A line break at the end of a chunk only counts if more data follows
+        held = 0;
+        while (held < 2 && held < len && (buf[len - 1 - held] == '\n' || buf[len - 1 - held] == '\r')) {
+            held++;
+        }
+
+        countSymbols(buf, len - held, sym0, sym1, counts);
+        if (counts->invalidPos != -1) {
+            counts->invalidPos += offset;
+            free(buf);
+            return 0;
+        }
+        offset += (long long)(len - held);
+        memmove(buf, buf + len - held, held);
+    }
+
+    int status = ferror(fp) ? -1 : 0;
+    // Whatever is held back is data unless it is exactly one line break
+    if (status == 0 && held > 0 &&
+        !(held == 1 && buf[0] == '\n') && !(held == 2 && buf[0] == '\r' && buf[1] == '\n')) {
+        countSymbols(buf, held, sym0, sym1, counts);
+        if (counts->invalidPos != -1) counts->invalidPos += offset;
+    }
+    free(buf);
+    return status;
+}
+
+#ifdef _WIN32
+#define symcountSeek _fseeki64
+#define symcountTell _ftelli64
+#else
+#define symcountSeek(fp, off, whence) fseeko(fp, (off_t)(off), whence)
+#define symcountTell ftello
+#endif
+
+// One thread's share of a parallel count: the byte range [start, start + length)
+typedef struct {
+    const char *path;
+    long long start;
+    long long length;
+    char sym0, sym1;
+    SymbolCounts counts;    // invalidPos is a file offset
+    int status;
+    int threaded;           // Ran on its own thread and must be joined
+} SymbolCountTask;
+
+static inline void *runSymbolCountTask(void *arg) {
+    SymbolCountTask *task = (SymbolCountTask *)arg;
+    FILE *fp = fopen(task->path, "rb");
+    char *buf = (char *)malloc(SYMCOUNT_CHUNK_SIZE);
+    long long done = 0;
+
+    initSymbolCounts(&task->counts);
+    task->status = -1;
+    if (fp == NULL || buf == NULL || symcountSeek(fp, task->start, SEEK_SET) != 0) goto out;
+
+    while (done < task->length) {
+        size_t want = SYMCOUNT_CHUNK_SIZE;
+        if ((long long)want > task->length - done) want = (size_t)(task->length - done);
+        if (fread(buf, 1, want, fp) != want) goto out;
+
+        countSymbols(buf, want, task->sym0, task->sym1, &task->counts);
+        if (task->counts.invalidPos != -1) {
+            task->counts.invalidPos += task->start + done;
+            break;
+        }
+        done += (long long)want;
+    }
+    task->status = 0;
+out:
+    if (fp != NULL) fclose(fp);
+    free(buf);
+    return NULL;
+}
+
+// Number of processors to use when the caller asks for "all of them"
+static inline int symcountDefaultThreads(void) {
+#ifdef _SC_NPROCESSORS_ONLN
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#else
+    return 1;
+#endif
+}
+
+// Count a regular file with up to `threads` threads, each scanning its own
+// contiguous range. The per-range counts are summed in file order up to the
+// first range holding an invalid byte, so the result (including invalidPos)
+// is identical to countSymbolsStream. Returns -1 on an I/O error.
+static inline int countSymbolsFileParallel(const char *path, int threads, char sym0, char sym1,
+                                           SymbolCounts *counts) {
+    FILE *fp = fopen(path, "rb");
+    long long size;
+    char tail[2];
+
+    if (fp == NULL) return -1;
+    if (symcountSeek(fp, 0, SEEK_END) != 0 || (size = (long long)symcountTell(fp)) < 0) {
+        fclose(fp);
+        return -1;
+    }
+
+    // Drop one trailing line break, as the streaming reader does
+    if (size >= 1 && symcountSeek(fp, size - 1, SEEK_SET) == 0 && fread(tail, 1, 1, fp) == 1 &&
+        tail[0] == '\n') {
+        size--;
+        if (size >= 1 && symcountSeek(fp, size - 1, SEEK_SET) == 0 && fread(tail, 1, 1, fp) == 1 &&
+            tail[0] == '\r') {
+            size--;
+        }
+    }
+    fclose(fp);
+
+    // Give every thread at least one chunk of work
+    if (threads <= 0) threads = symcountDefaultThreads();
+    if ((long long)threads > size / SYMCOUNT_CHUNK_SIZE) threads = (int)(size / SYMCOUNT_CHUNK_SIZE);
+    if (threads < 1) threads = 1;
+
+    SymbolCountTask *tasks = (SymbolCountTask *)calloc((size_t)threads, sizeof(SymbolCountTask));
+    pthread_t *ids = (pthread_t *)calloc((size_t)threads, sizeof(pthread_t));
+    int status = 0;
+    int i;
+
+    if (tasks == NULL || ids == NULL) {
+        free(tasks);
+        free(ids);
+        return -1;
+    }
+
+    for (i = 0; i < threads; i++) {
+        tasks[i].path = path;
+        tasks[i].start = size / threads * i;
+        tasks[i].length = (i == threads - 1) ? size - tasks[i].start : size / threads;
+        tasks[i].sym0 = sym0;
+        tasks[i].sym1 = sym1;
+    }
+    for (i = 1; i < threads; i++) {
+        tasks[i].threaded = pthread_create(&ids[i], NULL, runSymbolCountTask, &tasks[i]) == 0;
+    }
+    // The calling thread takes the first range and any range that failed to start
+    for (i = 0; i < threads; i++) {
+        if (!tasks[i].threaded) runSymbolCountTask(&tasks[i]);
+    }
+    for (i = 1; i < threads; i++) {
+        if (tasks[i].threaded) pthread_join(ids[i], NULL);
+    }
+
+    // Merge in file order: the earliest invalid byte wins
+    for (i = 0; i < threads; i++) {
+        if (tasks[i].status != 0) {
+            status = -1;
+            break;
+        }
+        counts->count0 += tasks[i].counts.count0;
+        counts->count1 += tasks[i].counts.count1;
+        if (tasks[i].counts.invalidPos != -1) {
+            counts->invalidPos = tasks[i].counts.invalidPos;
+            counts->invalidChar = tasks[i].counts.invalidChar;
+            break;
+        }
+    }
+
+    free(tasks);
+    free(ids);
+    return status;
+}
+
+// Output buffer size used by the batch (one record per line) modes
+#define SYMCOUNT_BATCH_BUFFER_SIZE (1 << 20)
+
+typedef void (*SymbolLineHandler)(const char *line, size_t len, void *context);
+
+// Call handler for every newline-delimited record of fp. The record excludes
+// the line break (a trailing '\r' is dropped too). The read buffer is reused
+// for the whole stream and only grows when a single record does not fit.
+static inline int forEachLine(FILE *fp, SymbolLineHandler handler, void *context) {
+    size_t cap = SYMCOUNT_CHUNK_SIZE;
+    char *buf = (char *)malloc(cap);
+    size_t len = 0;
+
+    if (buf == NULL) return -1;
+
+    for (;;) {
+        size_t got = fread(buf + len, 1, cap - len, fp);
+        len += got;
+
+        size_t start = 0;
+        for (;;) {
+            char *nl = (char *)memchr(buf + start, '\n', len - start);
+            if (nl == NULL) break;
+            size_t end = (size_t)(nl - buf);
+            size_t recordEnd = (end > start && buf[end - 1] == '\r') ? end - 1 : end;
+            handler(buf + start, recordEnd - start, context);
+            start = end + 1;
+        }
+
+        if (got == 0) {
+            // Last record without a line break
+            if (len > start) {
+                size_t recordEnd = (buf[len - 1] == '\r') ? len - 1 : len;
+                handler(buf + start, recordEnd - start, context);
+            }
+            break;
+        }
+
+        // Keep the partial record; grow only if it fills the whole buffer
+        memmove(buf, buf + start, len - start);
+        len -= start;
+        if (len == cap) {
+            char *bigger = (char *)realloc(buf, cap * 2);
+            if (bigger == NULL) {
+                free(buf);
+                return -1;
+            }
+            buf = bigger;
+            cap *= 2;
+        }
+    }
+
+    int status = ferror(fp) ? -1 : 0;
+    free(buf);
+    return status;
+}
+
+#endif // SYMCOUNT_H
@@ -0,0 +1,174 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+#include "workload.h"
+using namespace std;
+
+// Benchmark harness shared by the bench_* programs. Each benchmark times one
+// "operation" (a callable) repeatedly and reports:
+//   - throughput: items and bytes per second over all samples
+//   - latency:    min, p50, p90, p99 and max of the per-sample times
+//   - peak RSS:   the process high-water mark after the benchmark ran
+// Results are printed as a table and, with --json <file>, appended to that
+// file as one JSON object per line so runs can be diffed or plotted.
+
+struct BenchOptions {
+    string jsonPath;            // Empty: no JSON output
+    string filter;              // Only run benchmarks whose name contains this
+    double minTime = 0.5;       // Seconds of samples to collect per benchmark
+    int minSamples = 10;
+    int maxSamples = 100000;
+};
+
+// --json <file>, --filter <text>, --quick (shorter runs for smoke testing)
+inline BenchOptions parseBenchOptions(int argc, char* argv[]) {
+    BenchOptions options;
+    for(int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if(arg == "--json" && i + 1 < argc) options.jsonPath = argv[++i];
+        else if(arg == "--filter" && i + 1 < argc) options.filter = argv[++i];
+        else if(arg == "--quick") {
+            options.minTime = 0.05;
+            options.minSamples = 3;
+        } else {
+            cerr << "Usage: " << argv[0] << " [--json <file>] [--filter <text>] [--quick]\n";
+            exit(2);
+        }
+    }
+    return options;
+}
+
+// Peak resident set size of this process in KiB, 0 if unknown
+inline long long peakRssKb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return (long long)(counters.PeakWorkingSetSize / 1024);
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;      // Bytes on macOS
+#else
+    return usage.ru_maxrss;             // KiB on Linux
+#endif
+#endif
+}
+
+// Keep a result alive so the compiler cannot drop the work that produced it
+template <typename T>
+inline void keepResult(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct BenchResult {
+    string program;
+    string name;
+    size_t items;               // Items per sample (strings, states, ...)
+    size_t bytes;               // Input bytes per sample, 0 if not meaningful
+    vector<double> samples;     // Seconds per sample, sorted
+
+    double percentile(double p) const {
+        size_t index = (size_t)(p * (samples.size() - 1) + 0.5);
+        return samples[index];
+    }
+
+    double total() const {
+        double sum = 0;
+        for(double s : samples) sum += s;
+        return sum;
+    }
+};
+
+class BenchSuite {
+private:
+    string program;
+    BenchOptions options;
+
+    static string jsonEscape(const string& text) {
+        string escaped;
+        for(char c : text) {
+            if(c == '"' || c == '\\') escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+public:
+    BenchSuite(const string& programName, const BenchOptions& benchOptions) :
+        program(programName), options(benchOptions) {}
+
+    // Time op() until minTime seconds and minSamples samples have been collected
+    template <typename Op>
+    void run(const string& name, size_t items, size_t bytes, Op op) {
+        if(!options.filter.empty() && name.find(options.filter) == string::npos) return;
+
+        BenchResult result{program, name, items, bytes, {}};
+        op();                   // Warm-up: caches, page faults, lazy tables
+        double elapsed = 0;
+        while(result.samples.size() < (size_t)options.maxSamples &&
+              (elapsed < options.minTime || result.samples.size() < (size_t)options.minSamples)) {
+            auto begin = chrono::steady_clock::now();
+            op();
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+            result.samples.push_back(seconds);
+            elapsed += seconds;
+        }
+        sort(result.samples.begin(), result.samples.end());
+        report(result);
+    }
+
+private:
+    void report(const BenchResult& result) {
+        double seconds = result.total();
+        double count = (double)result.samples.size();
+        printf("%-40s %8zu samples  p50 %12.3f us  p99 %12.3f us  %14.0f items/s",
+               result.name.c_str(), result.samples.size(),
+               result.percentile(0.50) * 1e6, result.percentile(0.99) * 1e6,
+               result.items * count / seconds);
+        if(result.bytes > 0) printf("  %10.1f MB/s", result.bytes * count / seconds / 1e6);
+        printf("\n");
+        fflush(stdout);
+
+        if(options.jsonPath.empty()) return;
+        FILE* fp = fopen(options.jsonPath.c_str(), "a");
+        if(fp == nullptr) {
+            perror(options.jsonPath.c_str());
+            return;
+        }
+        fprintf(fp, "{\"program\":\"%s\",\"benchmark\":\"%s\",\"samples\":%zu,\"items\":%zu,\"bytes\":%zu,"
+                    "\"min_ns\":%.0f,\"p50_ns\":%.0f,\"p90_ns\":%.0f,\"p99_ns\":%.0f,\"max_ns\":%.0f,"
+                    "\"items_per_sec\":%.1f,\"bytes_per_sec\":%.1f,\"peak_rss_kb\":%lld}\n",
+                jsonEscape(result.program).c_str(), jsonEscape(result.name).c_str(),
+                result.samples.size(), result.items, result.bytes,
+                result.samples.front() * 1e9, result.percentile(0.50) * 1e9,
+                result.percentile(0.90) * 1e9, result.percentile(0.99) * 1e9,
+                result.samples.back() * 1e9,
+                result.items * count / seconds, result.bytes * count / seconds,
+                peakRssKb());
+        fclose(fp);
+    }
+};
+
+#endif // BENCH_H
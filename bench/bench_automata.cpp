@@ -0,0 +1,55 @@
+// FiniteAutomata::processString for one of the ass2 automata. Built once per
+// program; the Makefile passes
+//   AUTOMATON_SOURCE   the program to include, with its main renamed
+//   AUTOMATON_NAME     the name results are reported under
+//   AUTOMATON_SYMBOLS  its input alphabet, for the generated strings
+// and optionally AUTOMATON_LENGTHS (record lengths to time) and
+// AUTOMATON_LONG_INPUT=0 for automata that only read a fixed-length prefix.
+#include "bench.h"
+
+#ifndef AUTOMATON_LENGTHS
+#define AUTOMATON_LENGTHS {3, 4, 64, 4096}
+#endif
+#ifndef AUTOMATON_LONG_INPUT
+#define AUTOMATON_LONG_INPUT 1
+#endif
+
+#define main automatonMain
+#include AUTOMATON_SOURCE
+#undef main
+
+int main(int argc, char* argv[]) {
+    BenchSuite suite(AUTOMATON_NAME, parseBenchOptions(argc, argv));
+    BenchRandom random(2);
+    FiniteAutomata fa;
+    ostream discard(nullptr);
+    BufferedSink trace(discard);
+
+    // Short records of the lengths the programs are meant for, and longer ones
+    for(size_t length : AUTOMATON_LENGTHS) {
+        const int count = length < 1000 ? 10000 : 200;
+        vector<string> inputs;
+        for(int i = 0; i < count; i++) inputs.push_back(random.text(length, AUTOMATON_SYMBOLS));
+        size_t bytes = length * count;
+        string suffix = "/" + to_string(count) + "x" + to_string(length);
+
+        suite.run(string("processString-none") + suffix, count, bytes, [&] {
+            int accepted = 0;
+            for(const string& input : inputs) accepted += fa.processString(input, trace, TRACE_NONE);
+            keepResult(accepted);
+        });
+        suite.run(string("processString-steps") + suffix, count, bytes, [&] {
+            int accepted = 0;
+            for(const string& input : inputs) accepted += fa.processString(input, trace, TRACE_STEPS);
+            keepResult(accepted);
+        });
+    }
+
+    // One long input, the file mode workload
+    if(!AUTOMATON_LONG_INPUT) return 0;
+    string big = random.text(16 << 20, AUTOMATON_SYMBOLS);
+    suite.run("processString-none/16MiB", 1, big.size(), [&] {
+        keepResult(fa.processString(big, trace, TRACE_NONE));
+    });
+    return 0;
+}
@@ -0,0 +1,76 @@
+// Symbol counting (ass1/q1.c and ass1/q2.c). The programs are included with
+// their main renamed so the benchmarks call the real routines.
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#define dup _dup
+#define dup2 _dup2
+#define close _close
+#define NULL_DEVICE "NUL"
+#else
+#include <unistd.h>
+#define NULL_DEVICE "/dev/null"
+#endif
+#include "bench.h"
+
+#define main binaryMain
+#include "../ass1/q1.c"
+#undef main
+#define main characterMain
+#include "../ass1/q2.c"
+#undef main
+
+// Sends stdout to the null device for its lifetime, so the report lines the
+// routines print cost their formatting but not a terminal
+class QuietStdout {
+private:
+    int saved;
+
+public:
+    QuietStdout() {
+        fflush(stdout);
+        saved = dup(1);
+        int null = open(NULL_DEVICE, O_WRONLY);
+        dup2(null, 1);
+        close(null);
+    }
+
+    ~QuietStdout() {
+        fflush(stdout);
+        dup2(saved, 1);
+        close(saved);
+    }
+};
+
+int main(int argc, char* argv[]) {
+    BenchSuite suite("count", parseBenchOptions(argc, argv));
+    BenchRandom random(1);
+
+    const size_t bigLength = 64 << 20;
+    string binary = random.text(bigLength, "01");
+    string characters = random.text(bigLength, "ab");
+
+    suite.run("analyzeBinaryString/64MiB", 1, bigLength, [&] {
+        QuietStdout quiet;
+        analyzeBinaryString(&binary[0]);
+    });
+    suite.run("analyzeCharacterString/64MiB", 1, bigLength, [&] {
+        QuietStdout quiet;
+        analyzeCharacterString(&characters[0]);
+    });
+
+    // Batch mode: many short records, one result line each
+    const int records = 100000;
+    vector<string> lines;
+    size_t lineBytes = 0;
+    for(int i = 0; i < records; i++) {
+        lines.push_back(random.text(8 + random.below(120), "01"));
+        lineBytes += lines.back().size();
+    }
+    lines[records / 2][3] = 'x';
+    suite.run("classifyBinaryRecord/100k-records", records, lineBytes, [&] {
+        QuietStdout quiet;
+        for(const string& line : lines) classifyBinaryRecord(line.data(), line.size(), nullptr);
+    });
+    return 0;
+}
@@ -0,0 +1,49 @@
+// e-NFA to DFA conversion of ass3/q3.cpp: closures plus subset construction
+#include "bench.h"
+
+#define main eclosureMain
+#include "../ass1/ass3/q3.cpp"
+#undef main
+
+int main(int argc, char* argv[]) {
+    BenchSuite suite("eclosure", parseBenchOptions(argc, argv));
+
+    auto bench = [&](const string& name, const Automaton& automaton) {
+        vector<vector<string>> nfa = closureTable(automaton);
+        int states = automaton.states;
+        symbols = automaton.symbols;
+        vector<int> closure_ar(states);
+        vector<string> closure_table(states);
+        vector<DFA> dfa_states;
+        vector<vector<string>> DFA_TABLE;
+        auto convert = [&] {
+            compute_closures(states, closure_ar, closure_table, nfa);
+            convert_to_dfa(states, closure_table, nfa, dfa_states, DFA_TABLE);
+        };
+        convert();
+        suite.run("convert_to_dfa/" + name, zz, 0, [&] {
+            convert();
+            keepResult(zz);
+        });
+    };
+
+    // The program only handles single-digit states, so sweep the e-density
+    for(double density : {0.0, 0.25, 0.5}) {
+        WorkloadParams params;
+        params.states = 10;
+        params.symbols = 2;
+        params.epsilonDensity = density;
+        params.seed = 5;
+        bench("random-10x2-e" + to_string((int)(density * 100)), randomNFA(params));
+    }
+    WorkloadParams wide;
+    wide.states = 10;
+    wide.symbols = 4;
+    wide.epsilonDensity = 0.25;
+    wide.seed = 5;
+    bench("random-10x4-e25", randomNFA(wide));
+    for(int n : {4, 6, 8}) {
+        bench("nth-from-end-" + to_string(n), nthFromEndNFA(n, true));
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+// Set operations of ass2/q4.cpp: union, concatenation and (BA)*
+#include "bench.h"
+
+#define main languageMain
+#include "../ass1/ass2/q4.cpp"
+#undef main
+
+static Language randomWords(BenchRandom& random, int count) {
+    Language words;
+    for(int i = 0; i < count; i++) {
+        words.push_back(random.text(3 + random.below(8), "abcdefghijklmnopqrstuvwxyz"));
+    }
+    return words;
+}
+
+static Language firstWords(const Language& words, size_t count) {
+    Language result;
+    for(size_t i = 0; i < count; i++) result.push_back(words[i]);
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    BenchSuite suite("language", parseBenchOptions(argc, argv));
+    BenchRandom random(3);
+
+    Language A = randomWords(random, 50000);
+    Language B = randomWords(random, 50000);
+    suite.run("computeUnion/50k+50k", A.size() + B.size(), 0, [&] {
+        keepResult(computeUnion(A, B).size());
+    });
+
+    suite.run("hashUnion/50k+50k", A.size() + B.size(), 0, [&] {
+        keepResult(hashUnion(A, B).size());
+    });
+    Language half = firstWords(B, 25000);
+    half.append(firstWords(A, 25000));
+    suite.run("hashIntersection/50k+50k", A.size() + half.size(), 0, [&] {
+        keepResult(hashIntersection(A, half).size());
+    });
+    suite.run("sortedIntersection/50k+50k", A.size() + half.size(), 0, [&] {
+        keepResult(computeIntersection(A, half).size());
+    });
+    suite.run("hashDifference/50k+50k", A.size() + half.size(), 0, [&] {
+        keepResult(hashDifference(A, half).size());
+    });
+    suite.run("sortedDifference/50k+50k", A.size() + half.size(), 0, [&] {
+        keepResult(computeDifference(A, half).size());
+    });
+
+    // Large enough for the parallel sort and merge to split the work
+    Language bigA = randomWords(random, 2000000), bigB = randomWords(random, 2000000);
+    suite.run("computeUnion/2M+2M", bigA.size() + bigB.size(), 0, [&] {
+        keepResult(computeUnion(bigA, bigB).size());
+    });
+    suite.run("hashUnion/2M+2M", bigA.size() + bigB.size(), 0, [&] {
+        keepResult(hashUnion(bigA, bigB).size());
+    });
+
+    Language smallA = firstWords(A, 1000), smallB = firstWords(B, 1000);
+    suite.run("computeConcatenation/1000x1000", smallA.size() * smallB.size(), 0, [&] {
+        keepResult(computeConcatenation(smallA, smallB).size());
+    });
+
+    // The program's own sets, and wider ones where the result grows faster
+    Language words = {"big", "small"}, lengths = {"long", "short"};
+    size_t items = computeBAstar(lengths, words, 8).size();
+    suite.run("computeBAstar/2x2-n8", items, 0, [&] {
+        keepResult(computeBAstar(lengths, words, 8).size());
+    });
+
+    Language eightA = firstWords(A, 8), eightB = firstWords(B, 8);
+    items = computeBAstar(eightB, eightA, 2).size();
+    suite.run("computeBAstar/8x8-n2", items, 0, [&] {
+        keepResult(computeBAstar(eightB, eightA, 2).size());
+    });
+
+    // The lazy enumerator that main streams from; nothing is kept
+    items = computeBAstar(lengths, words, 8).size();
+    suite.run("BAStarEnumerator/2x2-n8", items, 0, [&] {
+        size_t bytes = 0;
+        for(BAStarEnumerator all(lengths, words, 8); !all.done(); all.advance()) bytes += all.current().size();
+        keepResult(bytes);
+    });
+
+    // The same closure as a DAWG, at sizes the word list cannot reach. Items
+    // are DAWG nodes: the word counts run into the quintillions.
+    DAWG compressed = computeBAstarCompressed(lengths, words, 13);
+    suite.run("computeBAstarCompressed/2x2-n13", compressed.nodeCount(), 0, [&] {
+        keepResult(computeBAstarCompressed(lengths, words, 13).nodeCount());
+    });
+    compressed = computeBAstarCompressed(eightB, eightA, 8);
+    suite.run("computeBAstarCompressed/8x8-n8", compressed.nodeCount(), 0, [&] {
+        keepResult(computeBAstarCompressed(eightB, eightA, 8).nodeCount());
+    });
+
+    Language probes;
+    for(BAStarEnumerator all(eightB, eightA, 3); !all.done() && probes.size() < 10000; all.advance()) {
+        probes.push_back(all.current());
+    }
+    suite.run("DAWG::contains/8x8-n8", probes.size(), probes.byteSize(), [&] {
+        size_t found = 0;
+        for(string_view word : probes) found += compressed.contains(word);
+        keepResult(found);
+    });
+
+    // Membership in (BA)* through the automaton: the cost per symbol should
+    // not depend on how many iterations the word spans
+    LanguageNFA star = buildBAstarNFA(lengths, words);
+    for(int iterations : {3, 300}) {
+        string word;
+        for(int i = 0; i < iterations; i++) word += (i % 2) ? "shortsmall" : "longbig";
+        suite.run("LanguageNFA::contains/(BA)^" + to_string(iterations), 1, word.size(), [&] {
+            keepResult(star.contains(word));
+        });
+    }
+    return 0;
+}
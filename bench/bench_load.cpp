@@ -0,0 +1,47 @@
+// Definition file loading shared by the ass3 programs (automaton_file.h),
+// building the compressed sparse rows of a SparseNFA (sparse_nfa.h) and
+// trimming it (trim.h)
+#include <cstdio>
+#include <fstream>
+#include "bench.h"
+#include "../ass1/ass3/trim.h"
+
+int main(int argc, char* argv[]) {
+    BenchSuite suite("load", parseBenchOptions(argc, argv));
+
+    // About 10^4, 10^5 and 10^6 moves (three symbols, up to three targets, some e-moves)
+    for(int states : {2000, 20000, 200000}) {
+        WorkloadParams params;
+        params.states = states;
+        params.symbols = 3;
+        params.outDegree = 3;
+        params.epsilonDensity = 0.2;
+        params.seed = 9;
+        string path = "bench_load_" + to_string(states) + ".tmp";
+        {
+            ofstream out(path);
+            writeDefinition(out, randomNFA(params));
+        }
+        MappedFile file;
+        AutomatonDefinition definition;
+        string error;
+        if(!file.open(path) || !loadAutomatonFile(path, definition, error)) {
+            cerr << "ERROR: " << error << "\n";
+            return 1;
+        }
+        suite.run("loadAutomatonFile/" + to_string(states) + "states", definition.moves.size(), file.size(), [&] {
+            loadAutomatonFile(path, definition, error);
+            keepResult(definition.moves.size());
+        });
+        suite.run("SparseNFA/" + to_string(states) + "states", definition.moves.size(), 0, [&] {
+            SparseNFA nfa(definition);
+            keepResult(nfa.moveCount());
+        });
+        SparseNFA nfa(definition);
+        suite.run("trimNFA/" + to_string(states) + "states", nfa.getNumStates(), 0, [&] {
+            keepResult(trimNFA(nfa).nfa.getNumStates());
+        });
+        remove(path.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,57 @@
+// DFA minimization of ass3/q4.cpp
+#include "bench.h"
+
+#define main minimizeMain
+#include "../ass1/ass3/q4.cpp"
+#undef main
+
+static DFA programDFA(const Automaton& automaton) {
+    DFA dfa;
+    dfa.states = automaton.states;
+    dfa.symbols = automaton.symbols;
+    dfa.initialState = 0;
+    dfa.transitions = dfaMatrix(automaton);
+    for(int s = 0; s < automaton.states; s++) {
+        if(automaton.accepting[s]) dfa.finalStates.insert(s);
+    }
+    return dfa;
+}
+
+int main(int argc, char* argv[]) {
+    BenchSuite suite("minimize", parseBenchOptions(argc, argv));
+
+    auto bench = [&](const string& name, const Automaton& automaton) {
+        DFA dfa = programDFA(automaton);
+        suite.run("minimizeDFA/" + name, dfa.states, 0, [&] {
+            keepResult(minimizeDFA(dfa).states);
+        });
+    };
+
+    for(int states : {64, 128, 256}) {
+        WorkloadParams params;
+        params.states = states;
+        params.symbols = 2;
+        params.fill = 1.0;
+        params.acceptRatio = 0.5;
+        params.seed = 6;
+        bench("random-" + to_string(states) + "x2", randomDFA(params));
+    }
+    WorkloadParams wide;
+    wide.states = 256;
+    wide.symbols = 8;
+    wide.fill = 1.0;
+    wide.acceptRatio = 0.5;
+    wide.seed = 6;
+    bench("random-256x8", randomDFA(wide));
+    bench("counter-240-mod-8", counterDFA(240, 8));
+
+    // Missing moves and useless states, which the trim step drops first
+    WorkloadParams partial;
+    partial.states = 256;
+    partial.symbols = 2;
+    partial.fill = 0.7;
+    partial.acceptRatio = 0.2;
+    partial.seed = 6;
+    bench("partial-256x2", randomDFA(partial));
+    return 0;
+}
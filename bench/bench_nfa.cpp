@@ -0,0 +1,72 @@
+// NFA membership runs of ass3/q1.cpp (BitParallelNFA and ShiftAndNFA)
+#include "bench.h"
+
+#define main nfaMain
+#include "../ass1/ass3/q1.cpp"
+#undef main
+
+static FiniteAutomaton toFiniteAutomaton(const Automaton& automaton) {
+    FiniteAutomaton fa(automaton.states, automaton.symbols);
+    for(int s = 0; s < automaton.states; s++) {
+        for(int c = 0; c < automaton.symbols; c++) {
+            for(int t : automaton.moves[s][c]) fa.addTransition(s, c, t);
+        }
+        if(automaton.accepting[s]) fa.addAcceptState(s);
+    }
+    return fa;
+}
+
+int main(int argc, char* argv[]) {
+    BenchSuite suite("nfa", parseBenchOptions(argc, argv));
+
+    // Up to 64 states takes the byte-table path, above it the word-by-word one.
+    // Inputs follow paths of the NFA so the active set stays populated.
+    for(int states : {16, 64, 256, 1024}) {
+        WorkloadParams params;
+        params.states = states;
+        params.symbols = 2;
+        params.outDegree = 3;
+        params.fill = 1.0;
+        params.seed = 6;
+        Automaton automaton = randomNFA(params);
+        BitParallelNFA runner(toFiniteAutomaton(automaton));
+        vector<string> inputs = walkWords(automaton, 1000, 256, 6);
+        size_t bytes = 0;
+        for(const string& input : inputs) bytes += input.size();
+        suite.run("BitParallelNFA::accepts/" + to_string(states) + "x2", inputs.size(), bytes, [&] {
+            size_t accepted = 0;
+            for(const string& input : inputs) accepted += runner.accepts(input);
+            keepResult(accepted);
+        });
+    }
+
+    // Pattern search: the position automaton of a pattern plus a self-loop on
+    // the start state, run by Shift-And and by the general engine for
+    // comparison. The 100-item pattern needs the 128-bit word.
+    string text;
+    uint32_t seed = 6;
+    for(int i = 0; i < 4096; i++) {
+        seed = seed * 1103515245 + 12345;
+        text += (char)('a' + (seed >> 16) % 3);
+    }
+    vector<string> texts(64, text);
+    size_t textBytes = texts.size() * text.size();
+    string longPattern;
+    for(int i = 0; i < 50; i++) longPattern += "a[bc]";
+    for(const string& pattern : {string("ab.[bc]+a"), longPattern}) {
+        FiniteAutomaton fa(0, 0);
+        patternAutomaton(pattern, 3, true, fa);
+        string name = to_string(fa.getNumStates()) + "states";
+        auto measure = [&](const string& engine, const auto& runner) {
+            suite.run(engine + "::accepts/search" + name, texts.size(), textBytes, [&] {
+                size_t accepted = 0;
+                for(const string& input : texts) accepted += runner.accepts(input);
+                keepResult(accepted);
+            });
+        };
+        if(ShiftAndNFA<uint64_t>::fits(fa)) measure("ShiftAndNFA<64>", ShiftAndNFA<uint64_t>(fa));
+        else measure("ShiftAndNFA<128>", ShiftAndNFA<unsigned __int128>(fa));
+        measure("BitParallelNFA", BitParallelNFA(fa));
+    }
+    return 0;
+}
@@ -0,0 +1,39 @@
+// NFA to DFA subset construction of ass3/q2.cpp
+#include "bench.h"
+
+#define main subsetMain
+#include "../ass1/ass3/q2.cpp"
+#undef main
+
+int main(int argc, char* argv[]) {
+    BenchSuite suite("subset", parseBenchOptions(argc, argv));
+
+    auto bench = [&](const string& name, const Automaton& automaton) {
+        vector<vector<string>> nfa = subsetTable(automaton);
+        vector<string> dfaStates;
+        vector<vector<string>> dfa;
+        convertToDFA(nfa, automaton.symbols, dfaStates, dfa);
+        suite.run("convertToDFA/" + name, dfaStates.size(), 0, [&] {
+            convertToDFA(nfa, automaton.symbols, dfaStates, dfa);
+            keepResult(dfaStates.size());
+        });
+    };
+
+    // Scaling in the NFA size, then the exponential family
+    for(int states : {8, 16, 32}) {
+        WorkloadParams params;
+        params.states = states;
+        params.symbols = 2;
+        params.seed = 4;
+        bench("random-" + to_string(states) + "x2", randomNFA(params));
+    }
+    WorkloadParams wide;
+    wide.states = 10;
+    wide.symbols = 4;
+    wide.seed = 4;
+    bench("random-10x4", randomNFA(wide));
+    for(int n : {6, 8, 10}) {
+        bench("nth-from-end-" + to_string(n), nthFromEndNFA(n));
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+// Writes a generated automaton as the standard input of one of the ass3
+// programs, or input strings for it, e.g.
+//
+//   ./generate nth-from-end -n 8 --for 2 | ../ass1/ass3/q2
+//   ./generate nfa -n 10 -k 3 -d 2 -e 0.3 -s 7 --for 3 | ../ass1/ass3/q3
+//   ./generate dfa -n 200 -k 2 -f 1 --for 4 | ../ass1/ass3/q4
+//   ./generate nfa -n 100000 -d 3 -e 0.1 --for file > nfa.txt   (any program, with -f nfa.txt)
+//   ./generate nfa -n 10 -s 7 --walk 100:64
+#include <cstdlib>
+#include <iostream>
+#include "workload.h"
+using namespace std;
+
+static void usage(const char* program) {
+    cerr << "Usage: " << program << " <family> [options]\n"
+         << "Families:\n"
+         << "  nfa           random NFA (e-NFA with -e > 0)\n"
+         << "  dfa           random DFA\n"
+         << "  nth-from-end  n-th symbol from the end is 'a' (-n is that n)\n"
+         << "  nth-from-end-e  the same behind an e-move\n"
+         << "  counter       counter modulo -n accepting multiples of -m\n"
+         << "Options:\n"
+         << "  -n <states>  -k <symbols>  -d <out-degree>  -f <fill ratio>\n"
+         << "  -e <e-density>  -a <accept ratio>  -m <modulus>  -s <seed>\n"
+         << "Output (default --for 2):\n"
+         << "  --for <1-4>               input script for ass3/q<1-4>\n"
+         << "  --for file                definition file for the -f option of all of them\n"
+         << "  --words <count>:<length>  random words over the alphabet\n"
+         << "  --walk <count>:<length>   words along random paths from the start\n";
+    exit(2);
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 2) usage(argv[0]);
+    string family = argv[1];
+    WorkloadParams params;
+    int modulus = 4;
+    int program = 2;
+    string wordMode;
+    int wordCount = 0;
+    size_t wordLength = 0;
+
+    for(int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if(i + 1 >= argc) usage(argv[0]);
+        const char* value = argv[++i];
+        if(arg == "-n") params.states = atoi(value);
+        else if(arg == "-k") params.symbols = atoi(value);
+        else if(arg == "-d") params.outDegree = atoi(value);
+        else if(arg == "-f") params.fill = atof(value);
+        else if(arg == "-e") params.epsilonDensity = atof(value);
+        else if(arg == "-a") params.acceptRatio = atof(value);
+        else if(arg == "-m") modulus = atoi(value);
+        else if(arg == "-s") params.seed = strtoull(value, nullptr, 10);
+        else if(arg == "--for") program = (string(value) == "file") ? 0 : atoi(value);
+        else if(arg == "--words" || arg == "--walk") {
+            wordMode = arg;
+            if(sscanf(value, "%d:%zu", &wordCount, &wordLength) != 2) usage(argv[0]);
+        }
+        else usage(argv[0]);
+    }
+    if(params.states < 1 || params.symbols < 1 || params.symbols > 26 || params.outDegree < 1 || modulus < 1) {
+        usage(argv[0]);
+    }
+
+    Automaton automaton;
+    if(family == "nfa") automaton = randomNFA(params);
+    else if(family == "dfa") automaton = randomDFA(params);
+    else if(family == "nth-from-end") automaton = nthFromEndNFA(params.states);
+    else if(family == "nth-from-end-e") automaton = nthFromEndNFA(params.states, true);
+    else if(family == "counter") automaton = counterDFA(params.states, modulus);
+    else usage(argv[0]);
+
+    try {
+        if(wordMode == "--words") {
+            for(const string& word : randomWords(automaton, wordCount, wordLength, params.seed)) cout << word << "\n";
+        } else if(wordMode == "--walk") {
+            for(const string& word : walkWords(automaton, wordCount, wordLength, params.seed)) cout << word << "\n";
+        } else if(program == 0) {
+            writeDefinition(cout, automaton);
+        } else {
+            writeScript(cout, automaton, program);
+        }
+    } catch(const invalid_argument& e) {
+        cerr << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,322 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <algorithm>
+#include <ostream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Seeded automata and input strings for scaling tests. The same seed and
+// parameters give the same automaton and inputs on every platform, so a curve
+// measured on one machine can be reproduced on another.
+
+// Fixed-seed generator, identical on every platform
+// (std::mt19937 is, but the standard distributions are not)
+class BenchRandom {
+private:
+    unsigned long long state;
+
+public:
+    explicit BenchRandom(unsigned long long seed) : state(seed) {}
+
+    unsigned long long next() {
+        // splitmix64
+        unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, bound)
+    int below(int bound) { return (int)(next() % (unsigned long long)bound); }
+
+    // True with probability p
+    bool chance(double p) { return (next() >> 11) * (1.0 / 9007199254740992.0) < p; }
+
+    string text(size_t length, const string& alphabet) {
+        string result(length, ' ');
+        for(char& c : result) c = alphabet[below((int)alphabet.size())];
+        return result;
+    }
+};
+
+// Automaton in a neutral form: moves[s][c] holds the sorted targets of state
+// s on symbol 'a' + c, epsilon[s] its e-moves. The start state is always 0,
+// which is what the ass3 programs assume.
+struct Automaton {
+    int states = 0;
+    int symbols = 0;
+    vector<vector<vector<int>>> moves;
+    vector<vector<int>> epsilon;
+    vector<bool> accepting;
+
+    Automaton() {}
+    Automaton(int stateCount, int symbolCount) :
+        states(stateCount), symbols(symbolCount),
+        moves(stateCount, vector<vector<int>>(symbolCount)),
+        epsilon(stateCount), accepting(stateCount, false) {}
+
+    bool hasEpsilon() const {
+        for(const auto& targets : epsilon) {
+            if(!targets.empty()) return true;
+        }
+        return false;
+    }
+
+    bool isDeterministic() const {
+        for(const auto& row : moves) {
+            for(const auto& targets : row) {
+                if(targets.size() > 1) return false;
+            }
+        }
+        return !hasEpsilon();
+    }
+
+    string alphabet() const {
+        string result;
+        for(int c = 0; c < symbols; c++) result += (char)('a' + c);
+        return result;
+    }
+};
+
+struct WorkloadParams {
+    int states = 8;
+    int symbols = 2;
+    int outDegree = 2;              // Largest number of targets per move (NFA)
+    double fill = 0.75;             // Share of (state, symbol) cells with a move
+    double epsilonDensity = 0.0;    // Share of states with e-moves
+    double acceptRatio = 0.25;      // Share of accepting states
+    unsigned long long seed = 1;
+};
+
+// n distinct sorted states, 1 <= n <= limit
+inline vector<int> randomTargets(BenchRandom& random, int states, int limit) {
+    set<int> targets;
+    int count = 1 + random.below(limit);
+    for(int k = 0; k < count; k++) targets.insert(random.below(states));
+    return vector<int>(targets.begin(), targets.end());
+}
+
+inline void randomAccepting(BenchRandom& random, Automaton& automaton, double ratio) {
+    for(int s = 0; s < automaton.states; s++) {
+        automaton.accepting[s] = random.chance(ratio);
+    }
+}
+
+// Random NFA; with epsilonDensity > 0 an e-NFA
+inline Automaton randomNFA(const WorkloadParams& params) {
+    BenchRandom random(params.seed);
+    Automaton automaton(params.states, params.symbols);
+    for(int s = 0; s < params.states; s++) {
+        for(auto& targets : automaton.moves[s]) {
+            if(random.chance(params.fill)) targets = randomTargets(random, params.states, params.outDegree);
+        }
+        if(random.chance(params.epsilonDensity)) {
+            automaton.epsilon[s] = randomTargets(random, params.states, params.outDegree);
+        }
+    }
+    randomAccepting(random, automaton, params.acceptRatio);
+    return automaton;
+}
+
+// Random DFA; complete when fill is 1
+inline Automaton randomDFA(const WorkloadParams& params) {
+    BenchRandom random(params.seed);
+    Automaton automaton(params.states, params.symbols);
+    for(auto& row : automaton.moves) {
+        for(auto& targets : row) {
+            if(random.chance(params.fill)) targets = {random.below(params.states)};
+        }
+    }
+    randomAccepting(random, automaton, params.acceptRatio);
+    return automaton;
+}
+
+// "The n-th symbol from the end is a" over {a, b}: n + 1 NFA states, and
+// subset construction has to build all 2^n DFA states. With an e-move in
+// front (state 0 only moves on e to state 1) it exercises the closures too.
+inline Automaton nthFromEndNFA(int n, bool epsilonStart = false) {
+    int offset = epsilonStart ? 1 : 0;
+    Automaton automaton(n + 1 + offset, 2);
+    if(epsilonStart) automaton.epsilon[0] = {1};
+    automaton.moves[offset][0] = {offset, offset + 1};
+    automaton.moves[offset][1] = {offset};
+    for(int i = 1; i < n; i++) {
+        automaton.moves[offset + i][0] = automaton.moves[offset + i][1] = {offset + i + 1};
+    }
+    automaton.accepting[offset + n] = true;
+    return automaton;
+}
+
+// Counter modulo n on 'a' that accepts multiples of k ('b' is a self-loop).
+// Minimizes to k states when k divides n, and pairwise marking needs about
+// n / k passes to get there.
+inline Automaton counterDFA(int n, int k) {
+    Automaton automaton(n, 2);
+    for(int s = 0; s < n; s++) {
+        automaton.moves[s][0] = {(s + 1) % n};
+        automaton.moves[s][1] = {s};
+        automaton.accepting[s] = (s % k == 0);
+    }
+    return automaton;
+}
+
+// Random words over the automaton's alphabet
+inline vector<string> randomWords(const Automaton& automaton, int count, size_t length, unsigned long long seed) {
+    BenchRandom random(seed);
+    vector<string> words;
+    for(int i = 0; i < count; i++) words.push_back(random.text(length, automaton.alphabet()));
+    return words;
+}
+
+// Words read along random paths from the start state (e-moves taken for
+// free), so they stay inside the automaton instead of dying early. A path
+// that reaches a state without moves ends there, giving a shorter word, and
+// so does one caught in an e-cycle.
+inline vector<string> walkWords(const Automaton& automaton, int count, size_t length, unsigned long long seed) {
+    BenchRandom random(seed);
+    vector<string> words;
+    for(int i = 0; i < count; i++) {
+        string word;
+        int state = 0;
+        for(size_t steps = 0; word.size() < length && steps < 4 * length + 16; steps++) {
+            if(!automaton.epsilon[state].empty() && random.chance(0.5)) {
+                state = automaton.epsilon[state][random.below((int)automaton.epsilon[state].size())];
+                continue;
+            }
+            vector<int> symbols;
+            for(int c = 0; c < automaton.symbols; c++) {
+                if(!automaton.moves[state][c].empty()) symbols.push_back(c);
+            }
+            if(symbols.empty()) {
+                if(automaton.epsilon[state].empty()) break;
+                state = automaton.epsilon[state][random.below((int)automaton.epsilon[state].size())];
+                continue;
+            }
+            int c = symbols[random.below((int)symbols.size())];
+            const vector<int>& targets = automaton.moves[state][c];
+            word += (char)('a' + c);
+            state = targets[random.below((int)targets.size())];
+        }
+        words.push_back(word);
+    }
+    return words;
+}
+
+// Cell of the digit-string tables of ass3/q2.cpp and q3.cpp: "-" or the
+// target states as characters '0' + state
+inline string digitCell(const vector<int>& targets) {
+    if(targets.empty()) return "-";
+    string cell;
+    for(int t : targets) cell += (char)('0' + t);
+    return cell;
+}
+
+// NFA table of ass3/q2.cpp. States past 9 use the characters after '9',
+// as that program's input check allows.
+inline vector<vector<string>> subsetTable(const Automaton& automaton) {
+    if(automaton.hasEpsilon()) throw invalid_argument("subsetTable: automaton has e-moves");
+    vector<vector<string>> table(automaton.states, vector<string>(automaton.symbols));
+    for(int s = 0; s < automaton.states; s++) {
+        for(int c = 0; c < automaton.symbols; c++) table[s][c] = digitCell(automaton.moves[s][c]);
+    }
+    return table;
+}
+
+// e-NFA table of ass3/q3.cpp, with e-moves in the last column. That program
+// prints closures with to_string, so it only supports single-digit states.
+inline vector<vector<string>> closureTable(const Automaton& automaton) {
+    if(automaton.states > 10) throw invalid_argument("closureTable: more than 10 states");
+    vector<vector<string>> table(automaton.states, vector<string>(automaton.symbols + 1));
+    for(int s = 0; s < automaton.states; s++) {
+        for(int c = 0; c < automaton.symbols; c++) table[s][c] = digitCell(automaton.moves[s][c]);
+        table[s][automaton.symbols] = digitCell(automaton.epsilon[s]);
+    }
+    return table;
+}
+
+// Transition matrix of ass3/q4.cpp, -1 for no move
+inline vector<vector<int>> dfaMatrix(const Automaton& automaton) {
+    if(!automaton.isDeterministic()) throw invalid_argument("dfaMatrix: automaton is not deterministic");
+    vector<vector<int>> matrix(automaton.states, vector<int>(automaton.symbols, -1));
+    for(int s = 0; s < automaton.states; s++) {
+        for(int c = 0; c < automaton.symbols; c++) {
+            if(!automaton.moves[s][c].empty()) matrix[s][c] = automaton.moves[s][c][0];
+        }
+    }
+    return matrix;
+}
+
+// Definition file read by every ass3 program with -f (see
+// ass1/ass3/automaton_file.h), one line per state and symbol with moves
+inline void writeDefinition(ostream& out, const Automaton& automaton) {
+    out << "states " << automaton.states << "\nsymbols " << automaton.symbols << "\nstart 0\naccept";
+    for(int s = 0; s < automaton.states; s++) {
+        if(automaton.accepting[s]) out << " " << s;
+    }
+    out << "\n";
+    for(int s = 0; s < automaton.states; s++) {
+        for(int c = 0; c <= automaton.symbols; c++) {
+            const vector<int>& targets = (c < automaton.symbols) ? automaton.moves[s][c] : automaton.epsilon[s];
+            if(targets.empty()) continue;
+            out << s << " ";
+            if(c < automaton.symbols) out << (char)('a' + c);
+            else out << "eps";
+            for(int t : targets) out << " " << t;
+            out << "\n";
+        }
+    }
+}
+
+// Standard input for one of the interactive ass3 programs (1 to 4), so a
+// generated automaton can be piped straight into it
+inline void writeScript(ostream& out, const Automaton& automaton, int program) {
+    // Convert first, so an automaton the program cannot take writes nothing
+    vector<vector<string>> table;
+    vector<vector<int>> matrix;
+    if(program == 2) table = subsetTable(automaton);
+    else if(program == 3) table = closureTable(automaton);
+    else if(program == 4) matrix = dfaMatrix(automaton);
+    else if(program != 1) throw invalid_argument("writeScript: program must be 1 to 4");
+
+    vector<int> accepting;
+    for(int s = 0; s < automaton.states; s++) {
+        if(automaton.accepting[s]) accepting.push_back(s);
+    }
+
+    out << automaton.states << " " << automaton.symbols << "\n";
+    if(program == 1) {
+        out << "0\n" << accepting.size();
+        for(int s : accepting) out << " " << s;
+        out << "\n";
+        for(const auto& row : automaton.moves) {
+            for(const auto& targets : row) {
+                if(targets.empty()) {
+                    out << "-1\n";
+                    continue;
+                }
+                out << targets.size();
+                for(int t : targets) out << " " << t;
+                out << "\n";
+            }
+        }
+    } else if(program == 4) {
+        for(const auto& row : matrix) {
+            for(size_t c = 0; c < row.size(); c++) out << (c ? " " : "") << row[c];
+            out << "\n";
+        }
+        out << accepting.size();
+        for(int s : accepting) out << " " << s;
+        out << "\n0\n";
+    } else {
+        for(const auto& row : table) {
+            for(size_t c = 0; c < row.size(); c++) out << (c ? " " : "") << row[c];
+            out << "\n";
+        }
+    }
+}
+
+#endif // WORKLOAD_H